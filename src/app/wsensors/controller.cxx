@@ -97,6 +97,15 @@ wsensors::Controller::Controller(wm_sensors::SensorsTree&& sensors, ui::SensorsT
 
 	ViewPopulationVisitor populationVisitor{this, view_, *model_, chipToViewMap_};
 	sensors_.chips().accept(populationVisitor);
+
+	// chips are refreshed by the scheduler at their own intervals, the view is updated at the UI one
+	for (const auto& p: chipToViewMap_) {
+		chipData_.insert({&p.first->chip(), p.first});
+	}
+	scheduler_.chipRefreshed.connect([this](const wm_sensors::SensorChip& chip) { chipData_.at(&chip)->update(); });
+	for (const auto& p: chipData_) {
+		scheduler_.add(*p.first);
+	}
 	updateThread_ = std::thread([this]() { this->updateThread(); });
 }
 
@@ -121,11 +130,7 @@ BOOL wsensors::Controller::PreTranslateMessage(MSG* pMsg)
 
 void wsensors::Controller::updateThread()
 {
-	// TODO get update timeout from chips
 	while (!shutdown_) {
-		for (auto& p : chipToViewMap_) {
-			p.first->update();
-		}
 		::PostThreadMessage(mainThreadId_, WM_SENSORS_UPDATED, 0, 0);
 		std::this_thread::sleep_for(std::chrono::milliseconds(settings_.uiUpdateInterval));
 	}
@@ -212,7 +217,7 @@ wsensors::Controller::ChannelItemsMap
 wsensors::Controller::createItemsForSensor(const CTreeItem& parent, const wm_sensors::HardwareType& id, const wm_sensors::SensorChip& chip)
 {
 	ChannelItemsMap channelItems;
-	wm_sensors::SensorChip::Config cfg = chip.config();
+	const auto cfg = chip.cachedConfig();
 
 	auto treeViewControl = view_.GetTreeControl();
 	CTreeItem chipNode =
@@ -220,14 +225,16 @@ wsensors::Controller::createItemsForSensor(const CTreeItem& parent, const wm_sen
 	NodeIcon icon = nodeIcon(id, chip.identifier().name);
 	treeViewControl.SetItemImage(chipNode, nodeIconIndices_[icon], nodeIconIndices_[icon]);
 
-	for (const auto& c: cfg.sensors) {
-		if (c.second.channelAttributes.size()) {
-			CTreeItem group = createTypeNode(chipNode, c.first);
-			for (std::size_t i = 0; i < c.second.channelAttributes.size(); ++i) {
-				if (chip.isVisible(c.first, wm_sensors::attributes::generic_input, i).any()) {
-					channelItems[c.first].push_back(view_.addSensorItem(group, toTString(chip.channelLabel(c.first, i)), c.first));
+	for (wm_sensors::u8 t = 0; t < wm_sensors::sensor_type_max; ++t) {
+		const auto type = static_cast<wm_sensors::SensorType>(t);
+		const auto& channelAttributes = cfg->sensors[t].channelAttributes;
+		if (channelAttributes.size()) {
+			CTreeItem group = createTypeNode(chipNode, type);
+			for (std::size_t i = 0; i < channelAttributes.size(); ++i) {
+				if (chip.isVisible(type, wm_sensors::attributes::generic_input, i).any()) {
+					channelItems[type].push_back(view_.addSensorItem(group, toTString(chip.channelLabel(type, i)), type));
 				} else {
-					channelItems[c.first].push_back(nullptr);
+					channelItems[type].push_back(nullptr);
 				}
 			}
 			treeViewControl.Expand(group);
@@ -3,6 +3,7 @@
 #include "./sensors_data_model.hxx"
 #include "./ui/sensors_tree.hxx"
 
+#include <lib/refresh_scheduler.hxx>
 #include <lib/sensor_tree.hxx>
 
 #include <map>
@@ -66,6 +67,8 @@ namespace wsensors {
 		ui::SensorsTree& view_;
 		const Settings& settings_;
 		std::map<ChipData*, ChipUpdateData> chipToViewMap_;
+		std::map<const wm_sensors::SensorChip*, ChipData*> chipData_;
+		wm_sensors::RefreshScheduler scheduler_;
 		std::thread updateThread_;
 		DWORD mainThreadId_;
 		std::map<NodeIcon, int> nodeIconIndices_;
@@ -3,8 +3,9 @@
 #include <cmath>
 #include <limits>
 
-wsensors::SensorValueFloat::SensorValueFloat(std::size_t channel)
+wsensors::SensorValueFloat::SensorValueFloat(std::size_t channel, wm_sensors::ChannelHandle handle)
     : channel_{channel}
+    , handle_{handle}
 {
 	reset();
 }
@@ -14,10 +15,10 @@ double wsensors::SensorValueFloat::stDev() const
 	return std::sqrt((sum2_ - (sum_ * sum_) / static_cast<double>(count_)) / static_cast<double>(count_ - 1));
 }
 
-void wsensors::SensorValueFloat::update(const wm_sensors::SensorChip& chip, wm_sensors::SensorType type)
+void wsensors::SensorValueFloat::update()
 {
 	double val;
-	if (chip.read(type, wm_sensors::attributes::generic_input, channel_, val) == 0) {
+	if (handle_.read(val) == 0) {
 		update(val);
 	}
 }
@@ -58,14 +59,17 @@ wsensors::ChipData::ChipData(const wm_sensors::SensorChip& chip)
 wsensors::ChipData wsensors::ChipData::fromSensorChip(const wm_sensors::SensorChip& chip)
 {
 	ChipData res{chip};
-	const auto cfg = chip.config();
-	for (const auto& s: cfg.sensors) {
-		for (std::size_t i = 0; i < s.second.channelAttributes.size(); ++i) {
-			if (chip.isVisible(s.first, wm_sensors::attributes::generic_input, i).none()) {
+	const auto cfg = chip.cachedConfig();
+	for (wm_sensors::u8 t = 0; t < wm_sensors::sensor_type_max; ++t) {
+		const auto type = static_cast<wm_sensors::SensorType>(t);
+		const auto& channelAttributes = cfg->sensors[t].channelAttributes;
+		for (std::size_t i = 0; i < channelAttributes.size(); ++i) {
+			if (chip.isVisible(type, wm_sensors::attributes::generic_input, i).none()) {
 				continue;
 			}
-			if (s.second.channelAttributes[i] & wm_sensors::attributes::generic_input) {
-				res.sensorValues_[s.first].emplace_back(i);
+			if (channelAttributes[i] & wm_sensors::attributes::generic_input) {
+				res.sensorValues_[type].emplace_back(
+				    i, chip.resolve(type, wm_sensors::attributes::generic_input, i));
 			}
 		}
 	}
@@ -74,9 +78,24 @@ wsensors::ChipData wsensors::ChipData::fromSensorChip(const wm_sensors::SensorCh
 
 void wsensors::ChipData::update()
 {
+	// read callback may be retried, hence values are collected first and accumulated afterwards
+	chip_.readConsistent([this] {
+		values_.clear();
+		for (const auto& sv: sensorValues_) {
+			for (const auto& cd: sv.second) {
+				double val = std::numeric_limits<double>::quiet_NaN();
+				cd.handle().read(val);
+				values_.push_back(val);
+			}
+		}
+	});
+	std::size_t i = 0;
 	for (auto& sv: sensorValues_) {
 		for (auto& cd: sv.second) {
-			cd.update(chip_, sv.first);
+			const double val = values_[i++];
+			if (!std::isnan(val)) {
+				cd.update(val);
+			}
 		}
 	}
 }
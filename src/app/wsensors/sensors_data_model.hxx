@@ -6,7 +6,7 @@
 namespace wsensors {
 	class SensorValueFloat {
 	public:
-		SensorValueFloat(std::size_t channel);
+		SensorValueFloat(std::size_t channel, wm_sensors::ChannelHandle handle);
 
 		std::size_t channel() const
 		{
@@ -39,12 +39,18 @@ namespace wsensors {
 			return count_;
 		}
 
-		void update(const wm_sensors::SensorChip& chip, wm_sensors::SensorType type);
+		const wm_sensors::ChannelHandle& handle() const
+		{
+			return handle_;
+		}
+
+		void update();
 		void update(double newValue);
 		void reset();
 
 	private:
 		std::size_t channel_; // have to keep channel here because there might be gaps in channel numbers
+		wm_sensors::ChannelHandle handle_;
 
 		double current_;
 		double max_;
@@ -61,9 +67,15 @@ namespace wsensors {
 		static ChipData fromSensorChip(const wm_sensors::SensorChip& chip);
 		ChipData(const ChipData&) = default;
 
+		/** Accumulates current values of the chip, which is refreshed by the caller */
 		void update();
 		void reset();
 
+		const wm_sensors::SensorChip& chip() const
+		{
+			return chip_;
+		}
+
 		const std::map<wm_sensors::SensorType, std::vector<SensorValueFloat>>& values() const
 		{
 			return sensorValues_;
@@ -76,6 +88,7 @@ namespace wsensors {
 
 		const wm_sensors::SensorChip& chip_;
 		std::map<wm_sensors::SensorType, std::vector<SensorValueFloat>> sensorValues_;
+		std::vector<double> values_; // scratch buffer for update()
 	};
 
 	using ChipDataTreeNode = wm_sensors::SensorTreeNode<wm_sensors::HardwareType, ChipData>;
@@ -3,16 +3,16 @@
 #include "./p7_h1.hxx"
 
 #include "../../impl/usbhid_chip.hxx"
+#include "../../../impl/channel_table.hxx"
 #include "../../../utility/hidapi++/hidapi.hxx"
 
 #include <array>
-#include <chrono>
-
-using namespace std::chrono_literals;
+#include <cerrno>
+#include <limits>
+#include <string>
 
 namespace {
 	constexpr const std::size_t fanCount = 5;
-	const auto updateTimeout = 1s;
 } // namespace
 
 std::vector<std::unique_ptr<wm_sensors::SensorChip>> wm_sensors::hardware::controller::aerocool::P7H1::probe()
@@ -29,16 +29,21 @@ std::vector<std::unique_ptr<wm_sensors::SensorChip>> wm_sensors::hardware::contr
 struct wm_sensors::hardware::controller::aerocool::P7H1::Impl {
 	Impl(hidapi::device&& dev)
 	    : device{std::move(dev)}
-	    , lastUpdate{std::chrono::steady_clock::now() - 2 * updateTimeout}
 	{
+		readings.fill(std::numeric_limits<double>::quiet_NaN());
+		for (std::size_t i = 0; i < fanCount; ++i) {
+			channels.add(SensorType::fan, attributes::fan_input | attributes::fan_label, "Fan #" + std::to_string(i + 1),
+			    &readings[i]);
+		}
+		channels.addChip(0, std::chrono::seconds(1));
 	}
 
 	void read();
 
 
-	std::array<u16, fanCount> readings;
+	std::array<double, fanCount> readings;
 	hidapi::device device;
-	std::chrono::steady_clock::time_point lastUpdate;
+	wm_sensors::impl::ChannelTable channels;
 };
 
 void wm_sensors::hardware::controller::aerocool::P7H1::Impl::read()
@@ -50,7 +55,6 @@ void wm_sensors::hardware::controller::aerocool::P7H1::Impl::read()
 		for (std::size_t i = 0; i < readings.size(); ++i) {
 			readings[i] = static_cast<u16>((buf[i * 3 + 2] << 8) + buf[i * 3 + 3]); // TODO unuligned_get
 		}
-		lastUpdate = std::chrono::steady_clock::now();
 	}
 }
 
@@ -65,40 +69,30 @@ wm_sensors::hardware::controller::aerocool::P7H1::~P7H1() = default;
 
 wm_sensors::SensorChip::Config wm_sensors::hardware::controller::aerocool::P7H1::config() const
 {
-	using namespace attributes;
+	return impl_->channels.config();
+}
 
-	return {{
-	    {SensorType::fan, {std::vector<u32>(fanCount, fan_input | fan_label)}},
-	}};
+void wm_sensors::hardware::controller::aerocool::P7H1::refreshValues() const
+{
+	impl_->read();
+	publish([this] { impl_->channels.publish(*enabledChannels()); });
 }
 
 int wm_sensors::hardware::controller::aerocool::P7H1::read(SensorType type, u32 attr, std::size_t channel, double& val) const
 {
-	if (type == SensorType::fan && attr == attributes::fan_input) {
-		if (std::chrono::steady_clock::now() > impl_->lastUpdate + updateTimeout) {
-			impl_->read();
-		}
-
-		if (channel < fanCount) {
-			val = impl_->readings[channel];
-			return 0;
-		}
-	}
-
-	return -EOPNOTSUPP;
+	const int res = impl_->channels.read(type, attr, channel, val);
+	return res == -ENOENT ? -EOPNOTSUPP : res;
 }
 
 int wm_sensors::hardware::controller::aerocool::P7H1::read(
     SensorType type, u32 attr, std::size_t channel, std::string_view& str) const
 {
-	static std::array<std::string_view, fanCount> labels = {
-		"Fan #1", "Fan #2", "Fan #3", "Fan #4"
-	};
-
-	if (type == SensorType::fan && attr == attributes::fan_label && channel < fanCount) {
-		str = labels[channel];
-		return 0;
-	}
+	const int res = impl_->channels.read(type, attr, channel, str);
+	return res == -ENOENT ? -EOPNOTSUPP : res;
+}
 
-	return -EOPNOTSUPP;
+const std::atomic<double>*
+wm_sensors::hardware::controller::aerocool::P7H1::valueSlot(SensorType type, u32 attr, std::size_t channel) const
+{
+	return impl_->channels.valueSlot(type, attr, channel);
 }
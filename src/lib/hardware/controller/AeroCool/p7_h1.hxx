@@ -26,6 +26,10 @@ namespace wm_sensors::hardware::controller::aerocool {
 
 		~P7H1();
 
+	protected:
+		void refreshValues() const override;
+		const std::atomic<double>* valueSlot(SensorType type, u32 attr, std::size_t channel) const override;
+
 	private:
 		P7H1(hidapi::device&& dev);
 		P7H1(const P7H1&) = delete;
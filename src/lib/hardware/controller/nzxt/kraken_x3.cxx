@@ -5,9 +5,12 @@
 #include "../../../utility/hidapi++/hidapi.hxx"
 #include "../../../utility/macro.hxx"
 #include "../../../utility/unaligned.hxx"
+#include "../../../impl/channel_table.hxx"
 #include "../../impl/usbhid_chip.hxx"
 
 #include <array>
+#include <cerrno>
+#include <limits>
 
 std::vector<std::unique_ptr<wm_sensors::SensorChip>> wm_sensors::hardware::controller::nzxt::KrakenX3::probe()
 {
@@ -19,26 +22,50 @@ std::vector<std::unique_ptr<wm_sensors::SensorChip>> wm_sensors::hardware::contr
 	    0x1e71);
 }
 
+namespace {
+	constexpr const std::chrono::milliseconds readInterval{500};
+} // namespace
+
 struct wm_sensors::hardware::controller::nzxt::KrakenX3::Impl: public impl::HidChipImplAutoRead {
-	Impl(hidapi::device&& dev)
-	    : HidChipImplAutoRead{std::move(dev), std::chrono::milliseconds(500)}
+	Impl(const KrakenX3& chip, hidapi::device&& dev)
+	    : HidChipImplAutoRead{std::move(dev), readInterval}
+	    , chip_{chip}
+	    , pumpRPM_{std::numeric_limits<double>::quiet_NaN()}
+	    , temperature_{std::numeric_limits<double>::quiet_NaN()}
+	{
+		channels.add(SensorType::temp, attributes::temp_input | attributes::temp_label, "Water", &temperature_);
+		channels.add(SensorType::fan, attributes::fan_input | attributes::fan_label, "Pump", &pumpRPM_);
+		// values do not change more often than the read thread polls the device
+		channels.addChip(0, readInterval);
+	}
+
+	~Impl() override
 	{
+		// readData() publishes from channels
+		stop();
 	}
 
 	DELETE_COPY_CTOR_AND_ASSIGNMENT(Impl)
 
 	bool readData() override;
 
-	u16 pumpRPM_;
-	float temperature_;
+	wm_sensors::impl::ChannelTable channels;
+
+private:
+	const KrakenX3& chip_;
+	double pumpRPM_;
+	double temperature_;
 };
 
 bool wm_sensors::hardware::controller::nzxt::KrakenX3::Impl::readData()
 {
 	std::array<u8, 64> data;
 	if (device().read(data.data(), data.size()) == data.size() && data[0] == 0x75 && data[1] == 0x02) {
-		temperature_ = data[15] + data[16] / 10.0f;
+		const auto acquired = SensorChip::Clock::now();
+		temperature_ = data[15] + data[16] / 10.0;
 		pumpRPM_ = utility::get_unaligned_le<u16>(&data[17]); // (data[18] << 8) | data[17];
+		// runs on the read thread, hand the values over to readers
+		chip_.publish([this] { channels.publish(*chip_.enabledChannels()); }, acquired);
 		return true;
 	}
 	return false;
@@ -47,7 +74,7 @@ bool wm_sensors::hardware::controller::nzxt::KrakenX3::Impl::readData()
 
 wm_sensors::hardware::controller::nzxt::KrakenX3::KrakenX3(hidapi::device&& dev)
     : base{{"Kraken X3", "controller", BusType::HID}}
-    , impl_{std::make_unique<Impl>(std::move(dev))}
+    , impl_{std::make_unique<Impl>(*this, std::move(dev))}
 {
 }
 
@@ -55,54 +82,31 @@ wm_sensors::hardware::controller::nzxt::KrakenX3::~KrakenX3() = default;
 
 wm_sensors::SensorChip::Config wm_sensors::hardware::controller::nzxt::KrakenX3::config() const
 {
-	return {{
-	    {SensorType::temp, {{attributes::temp_input | attributes::temp_label}}},
-	    {SensorType::fan, {{attributes::fan_input | attributes::fan_label}}},
-	}};
+	return impl_->channels.config();
+}
+
+void wm_sensors::hardware::controller::nzxt::KrakenX3::refreshValues() const
+{
+	// values are acquired by the read thread, we only have to keep it running
+	impl_->acknowledgeDataAccess();
 }
 
 int wm_sensors::hardware::controller::nzxt::KrakenX3::read(
     SensorType type, u32 attr, std::size_t channel, double& val) const
 {
-	switch (type) {
-		case SensorType::temp:
-			if (attr == attributes::temp_input && channel == 0) {
-				val = impl_->temperature_;
-				impl_->acknowledgeDataAccess();
-				return 0;
-			}
-			break;
-		case SensorType::fan:
-			if (attr == attributes::fan_input && channel == 0) {
-				val = impl_->pumpRPM_;
-				impl_->acknowledgeDataAccess();
-				return 0;
-			}
-			break;
-		default: break;
-	}
-	return -EOPNOTSUPP;
+	const int res = impl_->channels.read(type, attr, channel, val);
+	return res == -ENOENT ? -EOPNOTSUPP : res;
 }
 
 int wm_sensors::hardware::controller::nzxt::KrakenX3::read(
     SensorType type, u32 attr, std::size_t channel, std::string_view& str) const
 {
-	static std::array<std::string_view, 2> labels = {"Water", "Pump"};
-
-	switch (type) {
-		case SensorType::temp:
-			if (attr == attributes::temp_label && channel == 0) {
-				str = labels[0];
-				return 0;
-			}
-			break;
-		case SensorType::fan:
-			if (attr == attributes::fan_label && channel == 0) {
-				str = labels[1];
-				return 0;
-			}
-			break;
-		default: break;
-	}
-	return -EOPNOTSUPP;
+	const int res = impl_->channels.read(type, attr, channel, str);
+	return res == -ENOENT ? -EOPNOTSUPP : res;
+}
+
+const std::atomic<double>*
+wm_sensors::hardware::controller::nzxt::KrakenX3::valueSlot(SensorType type, u32 attr, std::size_t channel) const
+{
+	return impl_->channels.valueSlot(type, attr, channel);
 }
@@ -25,6 +25,10 @@ namespace wm_sensors::hardware::controller::nzxt {
 
 		~KrakenX3();
 
+	protected:
+		void refreshValues() const override;
+		const std::atomic<double>* valueSlot(SensorType type, u32 attr, std::size_t channel) const override;
+
 	private:
 		KrakenX3(hidapi::device&& dev);
 
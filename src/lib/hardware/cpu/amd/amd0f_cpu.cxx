@@ -7,7 +7,6 @@
 #include "../../impl/ring0.hxx"
 
 #include <limits>
-#include <thread>
 
 using namespace wm_sensors::stdtypes;
 
@@ -16,15 +15,11 @@ namespace {
 	const u16 MISCELLANEOUS_CONTROL_DEVICE_ID = 0x1103;
 	const u8 MISCELLANEOUS_CONTROL_FUNCTION = 3;
 	const unsigned THERMTRIP_STATUS_REGISTER = 0xE4;
-
-	const std::chrono::seconds updateInterval{1};
 } // namespace
 
 wm_sensors::hardware::cpu::Amd0FCpu::Amd0FCpu(unsigned processorIndex, std::vector<std::vector<CPUIDData>>&& cpuId)
     : base{processorIndex, std::move(cpuId)}
-    , baseChannels_{base::config().nrChannels()}
     , busClock_{std::numeric_limits<decltype(busClock_)>::quiet_NaN()}
-    , lastUpdate_{std::chrono::steady_clock::now() - 2 * updateInterval}
 {
 	temperatureOffset_ = -49.0f;
 
@@ -46,88 +41,35 @@ wm_sensors::hardware::cpu::Amd0FCpu::Amd0FCpu(unsigned processorIndex, std::vect
 
 	// check if processor supports a digital thermal sensor
 	if ((cpu0IdData().safeExtData(7, 3, 0) & 1) != 0) {
-		coreTemperatures_.resize(coreCount());
+		coreTemperatures_.resize(coreCount(), std::numeric_limits<double>::quiet_NaN());
+		for (std::size_t i = 0; i < coreTemperatures_.size(); ++i) {
+			channels().add(SensorType::temp, attributes::temp_input | attributes::temp_label, coreLabels()[i],
+			    &coreTemperatures_[i]);
+		}
 	}
 
 	miscellaneousControlAddress_ = PCIAddress(MISCELLANEOUS_CONTROL_FUNCTION, MISCELLANEOUS_CONTROL_DEVICE_ID);
 	if (hasTimeStampCounter()) {
-		coreClocks_.resize(coreCount());
-	}
-}
-
-wm_sensors::SensorChip::Config wm_sensors::hardware::cpu::Amd0FCpu::config() const
-{
-	Config res = base::config();
-	res.appendChannels(
-	    SensorType::frequency, 1 + coreClocks_.size(), attributes::frequency_input | attributes::frequency_label);
-	res.appendChannels(SensorType::temp, coreTemperatures_.size(), attributes::temp_input | attributes::temp_label);
-	return res;
-}
-
-int wm_sensors::hardware::cpu::Amd0FCpu::read(SensorType type, u32 attr, std::size_t channel, double& val) const
-{
-	std::size_t myChannel;
-
-	if (Config::isInRange(baseChannels_, type, channel, &myChannel)) {
-		if (std::chrono::steady_clock::now() > lastUpdate_ + updateInterval) {
-			this->update();
-		}
-		switch (type) {
-			case SensorType::temp:
-				if (myChannel < coreTemperatures_.size()) {
-					val = coreTemperatures_[myChannel];
-					return 0;
-				}
-				return -EOPNOTSUPP;
-			case SensorType::frequency:
-				if (myChannel == 0) {
-					val = busClock_ * 1e6;
-					return 0;
-				} else {
-					--myChannel;
-				}
-				if (myChannel < coreClocks_.size()) {
-					val = coreClocks_[myChannel];
-					return 0;
-				}
-				return -EOPNOTSUPP;
-			default: return -EOPNOTSUPP;
+		coreClocks_.resize(coreCount(), std::numeric_limits<double>::quiet_NaN());
+		// clocks are computed in MHz
+		channels().add(SensorType::frequency, attributes::frequency_input | attributes::frequency_label, "Bus Clock",
+		    &busClock_, 1e6);
+		for (std::size_t i = 0; i < coreClocks_.size(); ++i) {
+			channels().add(SensorType::frequency, attributes::frequency_input | attributes::frequency_label,
+			    coreLabels()[i], &coreClocks_[i], 1e6);
 		}
 	}
-	return base::read(type, attr, channel, val);
 }
 
-int wm_sensors::hardware::cpu::Amd0FCpu::read(SensorType type, u32 attr, std::size_t channel, std::string_view& str) const
+wm_sensors::SensorChip::RefreshDomain wm_sensors::hardware::cpu::Amd0FCpu::refreshDomain() const
 {
-	std::size_t myChannel;
-
-	if (Config::isInRange(baseChannels_, type, channel, &myChannel)) {
-		switch (type) {
-			case SensorType::temp:
-				if (myChannel < coreTemperatures_.size()) {
-					str = coreLabels()[myChannel];
-					return 0;
-				}
-				return -EOPNOTSUPP;
-			case SensorType::frequency:
-				if (myChannel == 0) {
-					str = "Bus Clock";
-					return 0;
-				} else {
-					--myChannel;
-				}
-				if (myChannel < coreClocks_.size()) {
-					str = coreLabels()[myChannel];
-					return 0;
-				}
-				return -EOPNOTSUPP;
-			default: return -EOPNOTSUPP;
-		}
-	}
-	return base::read(type, attr, channel, str);
+	// thermal trip PCI register is accessed under the ISA bus lock
+	RefreshDomain res = base::refreshDomain();
+	res.systemLocks |= impl::systemLockBit(impl::GlobalMutex::ISABus);
+	return res;
 }
 
-void wm_sensors::hardware::cpu::Amd0FCpu::update() const
+void wm_sensors::hardware::cpu::Amd0FCpu::refreshSensors() const
 {
 	if (miscellaneousControlAddress_ != impl::Ring0::INVALID_PCI_ADDRESS) {
 		impl::GlobalMutexTryLock lock{impl::GlobalMutex::ISABus, std::chrono::milliseconds(10)};
@@ -153,9 +95,11 @@ void wm_sensors::hardware::cpu::Amd0FCpu::update() const
 	if (hasTimeStampCounter()) {
 		double newBusClock = 0;
 
+		// FIDVID_STATUS is read on each core, the affinity switch is the only wait. Idle cores keep their clocks.
 		for (std::size_t i = 0; i < coreClocks_.size(); i++) {
-			std::this_thread::sleep_for(std::chrono::milliseconds(1));
-
+			if (!coreSampled(i)) {
+				continue;
+			}
 			u32 eax, edx;
 			if (impl::Ring0::instance().readMSR(FIDVID_STATUS, eax, edx, cpuId()[i][0].affinity())) {
 				// CurrFID can be found in eax bits 0-5, MaxFID in 16-21
@@ -172,6 +116,4 @@ void wm_sensors::hardware::cpu::Amd0FCpu::update() const
 
 		busClock_ = newBusClock > 0 ? newBusClock : std::numeric_limits<double>::quiet_NaN();
 	}
-
-	lastUpdate_ = std::chrono::steady_clock::now();
 }
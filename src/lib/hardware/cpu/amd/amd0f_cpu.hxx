@@ -14,9 +14,7 @@ namespace wm_sensors::hardware::cpu {
 	public:
 		Amd0FCpu(unsigned processorIndex, CpuIdDataArray&& cpuId);
 
-		Config config() const override;
-		int read(SensorType type, u32 attr, std::size_t channel, double& val) const override;
-		int read(SensorType type, u32 attr, std::size_t channel, std::string_view& str) const override;
+		RefreshDomain refreshDomain() const override;
 
 	protected:
 		/* uint[] GetMsrs()
@@ -37,10 +35,9 @@ namespace wm_sensors::hardware::cpu {
 #endif
 
 	private:
-		void update() const;
+		void refreshSensors() const override;
 		DELETE_COPY_CTOR_AND_ASSIGNMENT(Amd0FCpu)
 
-		Config::ChannelCounts baseChannels_;
 		unsigned miscellaneousControlAddress_;
 		u8 thermSenseCoreSelCPU0_;
 		u8 thermSenseCoreSelCPU1_;
@@ -49,7 +46,6 @@ namespace wm_sensors::hardware::cpu {
 		mutable double busClock_;
 		mutable std::vector<double> coreClocks_;
 		mutable std::vector<double> coreTemperatures_;
-		mutable std::chrono::steady_clock::time_point lastUpdate_;
 	};
 } // namespace wm_sensors::hardware::cpu
 
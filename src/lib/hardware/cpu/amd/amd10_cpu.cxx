@@ -2,6 +2,7 @@
 
 #include "./amd10_cpu.hxx"
 
+#include "../../impl/pinned_samplers.hxx"
 #include "../../impl/ring0.hxx"
 
 #include <Windows.h>
@@ -10,7 +11,6 @@
 #include <chrono>
 #include <cmath>
 #include <limits>
-#include <thread>
 
 namespace {
 	using namespace wm_sensors::stdtypes;
@@ -36,14 +36,16 @@ namespace {
 	const u16 FAMILY_15H_MODEL_70_MISC_CONTROL_DEVICE_ID = 0x15B3;
 	const u16 FAMILY_16H_MODEL_00_MISC_CONTROL_DEVICE_ID = 0x1533;
 	const u16 FAMILY_16H_MODEL_30_MISC_CONTROL_DEVICE_ID = 0x1583;
-
-	const std::chrono::seconds updateInterval{1};
 } // namespace
 
 wm_sensors::hardware::cpu::Amd10Cpu::Amd10Cpu(unsigned processorIndex, CpuIdDataArray&& cpuId)
     : base{processorIndex, std::move(cpuId)}
-    , baseChannels_{base::config().nrChannels()}
+    , busClock_{std::numeric_limits<double>::quiet_NaN()}
+    , coreTemperature_{std::numeric_limits<double>::quiet_NaN()}
+    , coreVoltage_{std::numeric_limits<double>::quiet_NaN()}
+    , northbridgeVoltage_{std::numeric_limits<double>::quiet_NaN()}
     , cStatesIoOffset_{0}
+    , timeStampCounterMultiplier_{0}
 {
 	
 	u16 miscellaneousControlDeviceId;
@@ -124,17 +126,53 @@ wm_sensors::hardware::cpu::Amd10Cpu::Amd10Cpu(unsigned processorIndex, CpuIdData
 	// get the pci address for the Miscellaneous Control registers
 	miscellaneousControlAddress_ = PCIAddress(MISCELLANEOUS_CONTROL_FUNCTION, miscellaneousControlDeviceId);
 	if (hasTimeStampCounter()) {
-		coreClock_.resize(coreCount());
+		coreClock_.resize(coreCount(), std::numeric_limits<double>::quiet_NaN());
 	}
 
 	impl::Ring0& ring0 = impl::Ring0::instance();
 
-	bool corePerformanceBoostSupport = (cpu0IdData().safeExtData(7, 3, 0) & (1 << 9)) > 0;
+	u32 addr = ring0.PCIAddress(0, 20, 0);
+	u32 dev, rev;
+	if (ring0.readPciConfig(addr, 0, dev)) {
+		ring0.readPciConfig(addr, 8, rev);
+
+		if (dev == 0x43851002)
+			cStatesIoOffset_ = static_cast<u8>((rev & 0xFF) < 0x40 ? 0xB3 : 0x9C);
+		else if (dev == 0x780B1022 || dev == 0x790B1022)
+			cStatesIoOffset_ = 0x9C;
+	}
+
+	if (cStatesIoOffset_ != 0) {
+		cStatesResidency_.resize(2, std::numeric_limits<double>::quiet_NaN());
+	}
+
+	channels().add(SensorType::temp, attributes::temp_input | attributes::temp_label, "CPU Cores", &coreTemperature_);
+	channels().add(SensorType::in, attributes::in_input | attributes::in_label, "CPU Cores", &coreVoltage_);
+	channels().add(SensorType::in, attributes::in_input | attributes::in_label, "Northbridge", &northbridgeVoltage_);
+	// clocks are computed in MHz
+	channels().add(SensorType::frequency, attributes::frequency_input | attributes::frequency_label, "Bus Speed",
+	    &busClock_, 1e6);
+	for (std::size_t i = 0; i < coreClock_.size(); ++i) {
+		channels().add(SensorType::frequency, attributes::frequency_input | attributes::frequency_label,
+		    coreLabels()[i], &coreClock_[i], 1e6);
+	}
+	const char* const cStateLabels[] = {"CPU Package C2", "CPU Package C3"};
+	for (std::size_t i = 0; i < cStatesResidency_.size(); ++i) {
+		channels().add(SensorType::fraction, attributes::generic_input | attributes::generic_label, cStateLabels[i],
+		    &cStatesResidency_[i]);
+	}
+}
 
-	{
-		// set affinity to the first thread for all frequency estimations
-		wm_sensors::impl::ThreadGroupAffinityGuard lock{cpu0IdData().affinity()};
+void wm_sensors::hardware::cpu::Amd10Cpu::initialize() const
+{
+	base::initialize();
+
+	impl::Ring0& ring0 = impl::Ring0::instance();
+
+	bool corePerformanceBoostSupport = (cpu0IdData().safeExtData(7, 3, 0) & (1 << 9)) > 0;
 
+	// run on the first thread for all frequency estimations
+	impl::PinnedSamplers::runOn(cpu0IdData().affinity(), [&] {
 		// disable core performance boost
 		impl::Ring0::MSRValue hwcr;
 		ring0.readMSR(HWCR, hwcr);
@@ -155,25 +193,10 @@ wm_sensors::hardware::cpu::Amd10Cpu::Amd10Cpu(unsigned processorIndex, CpuIdData
 		if (corePerformanceBoostSupport) {
 			ring0.writeMSR(HWCR, hwcr);
 		}
-	}
-
-	u32 addr = ring0.PCIAddress(0, 20, 0);
-	u32 dev, rev;
-	if (ring0.readPciConfig(addr, 0, dev)) {
-		ring0.readPciConfig(addr, 8, rev);
-
-		if (dev == 0x43851002)
-			cStatesIoOffset_ = static_cast<u8>((rev & 0xFF) < 0x40 ? 0xB3 : 0x9C);
-		else if (dev == 0x780B1022 || dev == 0x790B1022)
-			cStatesIoOffset_ = 0x9C;
-	}
-
-	if (cStatesIoOffset_ != 0) {
-		cStatesResidency_.resize(2);
-	}
+	});
 }
 
-double wm_sensors::hardware::cpu::Amd10Cpu::estimateTimeStampCounterMultiplier(double timeWindow)
+double wm_sensors::hardware::cpu::Amd10Cpu::estimateTimeStampCounterMultiplier(double timeWindow) const
 {
 	auto& ring0 = impl::Ring0::instance();
 	// select event "076h CPU Clocks not Halted" and enable the counter
@@ -221,108 +244,7 @@ double wm_sensors::hardware::cpu::Amd10Cpu::estimateTimeStampCounterMultiplier(d
 	return 0.25 * std::round(4 * timeStampCounterFrequency() / busFrequency);
 }
 
-wm_sensors::SensorChip::Config wm_sensors::hardware::cpu::Amd10Cpu::config() const
-{
-	Config res = base::config();
-	res.appendChannels(SensorType::temp, 1, attributes::temp_input | attributes::temp_label);
-	res.appendChannels(SensorType::in, 2, attributes::in_input | attributes::in_label);
-	res.appendChannels(
-	    SensorType::frequency, 1 + coreClock_.size(), attributes::frequency_input | attributes::frequency_label);
-	res.appendChannels(
-	    SensorType::fraction, cStatesResidency_.size(), attributes::generic_input | attributes::generic_label);
-	return res;
-}
-
-int wm_sensors::hardware::cpu::Amd10Cpu::read(SensorType type, u32 attr, std::size_t channel, double& val) const
-{
-	std::size_t myChannel;
-
-	if (Config::isInRange(baseChannels_, type, channel, &myChannel)) {
-		if (std::chrono::steady_clock::now() > lastUpdate_ + updateInterval) {
-			this->update();
-		}
-		switch (type) {
-			case SensorType::temp:
-				if (myChannel == 0) {
-					val = coreTemperature_;
-					return 0;
-				}
-				return -EOPNOTSUPP;
-			case SensorType::in:
-				switch (myChannel) {
-					case 0: val = coreVoltage_; return 0;
-					case 1: val = northbridgeVoltage_; return 0;
-					default: return -EOPNOTSUPP;
-				}
-			case SensorType::frequency:
-				if (myChannel == 0) {
-					val = busClock_;
-					return 0;
-				} else {
-					--myChannel;
-				}
-				if (myChannel < coreClock_.size()) {
-					val = coreClock_[myChannel];
-					return 0;
-				}
-				return -EOPNOTSUPP;
-			case SensorType::fraction:
-				if (myChannel < cStatesResidency_.size()) {
-					val = cStatesResidency_[myChannel];
-					return 0;
-				}
-				return -EOPNOTSUPP;
-			default: return -EOPNOTSUPP;
-		}
-	}
-	return base::read(type, attr, channel, val);
-}
-
-int wm_sensors::hardware::cpu::Amd10Cpu::read(SensorType type, u32 attr, std::size_t channel, std::string_view& str) const
-{
-	std::size_t myChannel;
-
-	if (Config::isInRange(baseChannels_, type, channel, &myChannel)) {
-		switch (type) {
-			case SensorType::temp:
-				if (myChannel == 0) {
-					str = "CPU Cores";
-					return 0;
-				}
-				return -EOPNOTSUPP;
-			case SensorType::in:
-				switch (myChannel) {
-					case 0: str = "CPU Cores"; return 0;
-					case 1: str = "Northbridge"; return 0;
-					default: return -EOPNOTSUPP;
-				}
-			case SensorType::frequency:
-				if (myChannel == 0) {
-					str = "Bus Speed";
-					return 0;
-				} else {
-					--myChannel;
-				}
-				if (myChannel < coreClock_.size()) {
-					str = coreLabels()[myChannel];
-					return 0;
-				}
-				return -EOPNOTSUPP;
-			case SensorType::fraction:
-				if (myChannel < cStatesResidency_.size()) {
-					switch (myChannel) {
-						case 0: str = "CPU Package C2"; return 0;
-						case 1: str = "CPU Package C3"; return 0;
-					}
-				}
-				return -EOPNOTSUPP;
-			default: return -EOPNOTSUPP;
-		}
-	}
-	return base::read(type, attr, channel, str);
-}
-
-double wm_sensors::hardware::cpu::Amd10Cpu::estimateTimeStampCounterMultiplier()
+double wm_sensors::hardware::cpu::Amd10Cpu::estimateTimeStampCounterMultiplier() const
 {
 	// preload the function
 	estimateTimeStampCounterMultiplier(0);
@@ -388,7 +310,16 @@ double wm_sensors::hardware::cpu::Amd10Cpu::coreMultiplier(u32 cofVidEax) const
 	}
 }
 
-void wm_sensors::hardware::cpu::Amd10Cpu::update() const {
+wm_sensors::SensorChip::RefreshDomain wm_sensors::hardware::cpu::Amd10Cpu::refreshDomain() const
+{
+	// northbridge registers are read under the PCI bus lock
+	RefreshDomain res = base::refreshDomain();
+	res.systemLocks |= impl::systemLockBit(impl::GlobalMutex::PCIBus);
+	return res;
+}
+
+void wm_sensors::hardware::cpu::Amd10Cpu::refreshSensors() const
+{
 	auto& ring0 = impl::Ring0::instance();
 
 	if (miscellaneousControlAddress_ != impl::Ring0::INVALID_PCI_ADDRESS) {
@@ -420,9 +351,14 @@ void wm_sensors::hardware::cpu::Amd10Cpu::update() const {
 	if (hasTimeStampCounter()) {
 		double newBusClock = 0;
 		float maxCoreVoltage = 0, maxNbVoltage = 0;
+		bool voltagesRead = false;
 
+		// COFVID_STATUS is read on each core, the affinity switch is the only wait. Idle cores keep their clocks
+		// and do not take part in the voltages, they run at the lowest P-state.
 		for (std::size_t i = 0; i < coreClock_.size(); i++) {
-			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+			if (!coreSampled(i)) {
+				continue;
+			}
 			impl::Ring0::MSRValue cofVid;
 			if (ring0.readMSR(COFVID_STATUS, cofVid, cpuIdData()[i][0].affinity())) {
 				double multiplier = coreMultiplier(cofVid.reg.eax);
@@ -431,6 +367,7 @@ void wm_sensors::hardware::cpu::Amd10Cpu::update() const {
 				newBusClock = timeStampCounterFrequency() / timeStampCounterMultiplier_;
 			} else {
 				coreClock_[i] = timeStampCounterFrequency();
+				continue;
 			}
 
 			auto SVI2Volt = [](u32 vid) -> float {
@@ -455,10 +392,13 @@ void wm_sensors::hardware::cpu::Amd10Cpu::update() const {
 
 			if (newNbVoltage > maxNbVoltage)
 				maxNbVoltage = newNbVoltage;
+			voltagesRead = true;
 		}
 
-		coreVoltage_ = maxCoreVoltage;
-		northbridgeVoltage_ = maxNbVoltage;
+		if (voltagesRead) {
+			coreVoltage_ = maxCoreVoltage;
+			northbridgeVoltage_ = maxNbVoltage;
+		}
 
 		if (newBusClock > 0) {
 			busClock_ = newBusClock;
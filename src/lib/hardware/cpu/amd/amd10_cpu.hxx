@@ -16,13 +16,11 @@ namespace wm_sensors::hardware::cpu {
 	public:
 		Amd10Cpu(unsigned processorIndex, CpuIdDataArray&& cpuId);
 
-		Config config() const override;
-		int read(SensorType type, u32 attr, std::size_t channel, double& val) const override;
-		int read(SensorType type, u32 attr, std::size_t channel, std::string_view& str) const override;
+		RefreshDomain refreshDomain() const override;
 
 	private:
-		double estimateTimeStampCounterMultiplier(double timeWindow);
-		double estimateTimeStampCounterMultiplier();
+		double estimateTimeStampCounterMultiplier(double timeWindow) const;
+		double estimateTimeStampCounterMultiplier() const;
 
 
 #if 0
@@ -55,11 +53,11 @@ namespace wm_sensors::hardware::cpu {
 		double coreMultiplier(u32 cofVidEax) const;
 
 	private:
-		void update() const;
+		void initialize() const override;
+		void refreshSensors() const override;
 		static bool readSMURegister(u32 address, u32& value);
 		DELETE_COPY_CTOR_AND_ASSIGNMENT(Amd10Cpu)
 
-		Config::ChannelCounts baseChannels_;
 
 		mutable double busClock_;
 		mutable std::vector<double> coreClock_;
@@ -68,13 +66,12 @@ namespace wm_sensors::hardware::cpu {
 		mutable double coreTemperature_;
 		mutable double coreVoltage_;
 		mutable double northbridgeVoltage_;
-		mutable std::chrono::steady_clock::time_point lastUpdate_;
 
 		u8 cStatesIoOffset_;
 		bool isSvi2_;
 		bool hasSmuTemperatureRegister_;
 		u32 miscellaneousControlAddress_;
-		double timeStampCounterMultiplier_;
+		mutable double timeStampCounterMultiplier_;
 	};
 } // namespace wm_sensors::hardware::cpu
 
@@ -23,6 +23,7 @@
 
 namespace {
 	using namespace wm_sensors::stdtypes;
+	using wm_sensors::SensorChip;
 	using wm_sensors::SensorType;
 	using wm_sensors::hardware::cpu::Amd17Cpu;
 	using wm_sensors::hardware::cpu::CPUIDData;
@@ -49,8 +50,6 @@ namespace {
 
 	const u32 PERF_CTR_0 = 0xC0010004;
 
-	const auto updateTimeout = std::chrono::seconds(1);
-
 	struct tctl_offset {
 		tctl_offset(u8 pModel, const char* pId, float pOffset)
 		    : id{pId}
@@ -229,7 +228,15 @@ namespace {
 			return threads_;
 		}
 
-		void updateSensors() const;
+		/** Appends reads of the core registers to the batch, returns false if the core is not sampled */
+		bool requestRegisters(const SensorChip::ChannelMask& sampled, std::vector<Ring0::MSRRead>& batch) const;
+		/** Updates the sensors from the registers appended by requestRegisters() */
+		void updateSensors(const Ring0::MSRRead* registers, std::chrono::steady_clock::time_point sampleTime) const;
+
+		bool owns(SensorHandle sensor) const
+		{
+			return sensor == clock_ || sensor == multiplier_ || sensor == power_ || sensor == vcore_;
+		}
 
 	private:
 		DELETE_COPY_CTOR_AND_ASSIGNMENT(Core)
@@ -291,6 +298,8 @@ public:
 	}
 
 	void updateSensors();
+	/** Channel group and cost of a collection sensor */
+	SensorChip::ChannelCost readCost(SensorHandle sensor) const;
 
 	wm_sensors::impl::SensorCollection<Sensor>& sensorsCollection()
 	{
@@ -414,9 +423,34 @@ wm_sensors::SensorChip::Config wm_sensors::hardware::cpu::Amd17Cpu::config() con
 	return res;
 }
 
-int wm_sensors::hardware::cpu::Amd17Cpu::read(SensorType type, u32 attr, std::size_t channel, double& val) const
+wm_sensors::SensorChip::RefreshDomain wm_sensors::hardware::cpu::Amd17Cpu::refreshDomain() const
+{
+	// SMU is accessed under the PCI bus lock
+	RefreshDomain res = base::refreshDomain();
+	res.systemLocks |= hardware::impl::systemLockBit(hardware::impl::GlobalMutex::PCIBus);
+	return res;
+}
+
+wm_sensors::SensorChip::ChannelCost
+wm_sensors::hardware::cpu::Amd17Cpu::readCost(SensorType type, std::size_t channel) const
+{
+	const auto sensor = impl_->sensorsCollection().handle(type, channel);
+	return sensor ? impl_->readCost(sensor) : base::readCost(type, channel);
+}
+
+void wm_sensors::hardware::cpu::Amd17Cpu::refreshSensors() const
 {
 	impl_->updateSensors();
+}
+
+void wm_sensors::hardware::cpu::Amd17Cpu::publishValues() const
+{
+	base::publishValues();
+	impl_->sensorsCollection().publish(sampledChannels());
+}
+
+int wm_sensors::hardware::cpu::Amd17Cpu::read(SensorType type, u32 attr, std::size_t channel, double& val) const
+{
 	int r = impl_->sensorsCollection().read(type, attr, channel, val);
 	if (!r) {
 		return r;
@@ -425,6 +459,13 @@ int wm_sensors::hardware::cpu::Amd17Cpu::read(SensorType type, u32 attr, std::si
 	return base::read(type, attr, channel, val);
 }
 
+const std::atomic<double>*
+wm_sensors::hardware::cpu::Amd17Cpu::valueSlot(SensorType type, u32 attr, std::size_t channel) const
+{
+	const std::atomic<double>* res = impl_->sensorsCollection().valueSlot(type, attr, channel);
+	return res ? res : base::valueSlot(type, attr, channel);
+}
+
 int wm_sensors::hardware::cpu::Amd17Cpu::read(
     SensorType type, u32 attr, std::size_t channel, std::string_view& str) const
 {
@@ -502,8 +543,8 @@ void wm_sensors::hardware::cpu::Amd17Cpu::Impl::detectOptionalSensors()
 		}
 	}
 
+	// SMN registers are reached through PCI configuration space, which does not depend on the current CPU
 	hardware::impl::GlobalMutexLock pciLock{hardware::impl::GlobalMutex::PCIBus, std::chrono::milliseconds(10)};
-	wm_sensors::impl::ThreadGroupAffinityGuard affinityGuard{cpu_.cpu0IdData().affinity()};
 
 	if (supportsPerCcdTemperatures) {
 		const CCDInfo ccdInf = ccdInfo(cpu_.family(), cpu_.model());
@@ -569,29 +610,19 @@ double wm_sensors::hardware::cpu::Amd17Cpu::Impl::timeStampCounterMultiplier()
 
 void wm_sensors::hardware::cpu::Amd17Cpu::Impl::updateSensors()
 {
-	if (std::chrono::steady_clock::now() - lastPwrTime_ < updateTimeout) {
-		return;
-	}
-
 	const CPUIDData* cpuId = firstThreadData();
 	if (!cpuId) {
 		return;
 	}
 
 	auto& ring0 = Ring0::instance();
-	wm_sensors::impl::ThreadGroupAffinityGuard affinityGuard{cpuId->affinity()};
-
-	// MSRC001_0299
-	// TU [19:16]
-	// ESU [12:8] -> Unit 15.3 micro Joule per increment
-	// PU [3:0]
-	Ring0::MSRValue tmpMSR;
-	ring0.readMSR(MSR_PWR_UNIT, tmpMSR);
 
 	// MSRC001_029B
 	// total_energy [31:0]
+	// the energy unit (MSRC001_0299 ESU [12:8]) is taken as 15.3 micro Joule per increment
 	const auto sampleTime = std::chrono::steady_clock::now();
-	ring0.readMSR(MSR_PKG_ENERGY_STAT, tmpMSR);
+	Ring0::MSRValue tmpMSR;
+	ring0.readMSR(MSR_PKG_ENERGY_STAT, tmpMSR, cpuId->affinity());
 
 	unsigned totalEnergy = tmpMSR.reg.eax;
 
@@ -599,6 +630,7 @@ void wm_sensors::hardware::cpu::Amd17Cpu::Impl::updateSensors()
 	unsigned smuSvi0TelPlane0 = 0;
 	unsigned smuSvi0TelPlane1 = 0;
 
+	const auto smnStart = std::chrono::steady_clock::now();
 	hardware::impl::GlobalMutexTryLock pciLock{hardware::impl::GlobalMutex::PCIBus, std::chrono::milliseconds(10)};
 	if (pciLock.succeded()) {
 		// THM_TCON_CUR_TMP
@@ -617,8 +649,6 @@ void wm_sensors::hardware::cpu::Amd17Cpu::Impl::updateSensors()
 		// SVI0_PLANE1_IDDCOR [7:0]
 		smuSvi0TelPlane1 = smn_.read(sviPlane1Offset_);
 
-		affinityGuard.release(); // TODO refactor blocks
-
 		// power consumption
 		// power.Value = (float) ((double)pu * 0.125);
 		// esu = 15.3 micro Joule per increment
@@ -684,6 +714,7 @@ void wm_sensors::hardware::cpu::Amd17Cpu::Impl::updateSensors()
 			sensors_[ccdsMaxTemperature_].value(maxTemp);
 			sensors_[ccdsAverageTemperature_].value(tempSum / static_cast<double>(ccdSensors_.size()));
 		}
+		cpu_.recordReadLatency("smn", std::chrono::steady_clock::now() - smnStart);
 	}
 
 	// voltage
@@ -707,7 +738,11 @@ void wm_sensors::hardware::cpu::Amd17Cpu::Impl::updateSensors()
 
 	sensors_[busClock_].value(cpu_.timeStampCounterFrequency() / this->timeStampCounterMultiplier());
 
-	if (!smuSensors_.empty()) {
+	// the PM table transfer is the most expensive read here
+	const SensorChip::ChannelMask& sampled = cpu_.sampledChannels();
+	if (std::any_of(smuSensors_.begin(), smuSensors_.end(),
+	        [&](const auto& s) { return sensors_.enabled(sampled, s.second.second); })) {
+		SensorChip::ReadTimer timer{cpu_, "smu"};
 		std::vector<float> smuData = smu_.pmTable();
 
 		for (auto& sensor: smuSensors_) {
@@ -717,13 +752,53 @@ void wm_sensors::hardware::cpu::Amd17Cpu::Impl::updateSensors()
 		}
 	}
 
+	// registers of all cores are read in a single batch
+	std::vector<Ring0::MSRRead> batch;
+	std::vector<std::pair<const Core*, std::size_t>> requests; // core and its first read in the batch
 	for (const NumaNode& node: nodes_) {
 		node.updateSensors();
 
 		for (const Core& c: node.cores()) {
-			c.updateSensors();
+			// reading the registers wakes the core, idle ones keep their values
+			if (!c.threads().empty() && !cpu_.coreSampled(*c.threads()[0])) {
+				continue;
+			}
+			const std::size_t first = batch.size();
+			if (c.requestRegisters(sampled, batch)) {
+				requests.emplace_back(&c, first);
+			}
+		}
+	}
+	if (batch.empty()) {
+		return;
+	}
+	{
+		SensorChip::ReadTimer timer{cpu_, "cores"};
+		Ring0::instance().readMSRs(batch);
+	}
+	const auto coresSampleTime = std::chrono::steady_clock::now();
+	for (const auto& r: requests) {
+		r.first->updateSensors(batch.data() + r.second, coresSampleTime);
+	}
+}
+
+wm_sensors::SensorChip::ChannelCost
+wm_sensors::hardware::cpu::Amd17Cpu::Impl::readCost(SensorHandle sensor) const
+{
+	// the PM table is transferred by an SMU mailbox command into mapped physical memory
+	for (const auto& s: smuSensors_) {
+		if (s.second.second == sensor) {
+			return {SensorChip::ReadCost::Firmware, "smu"};
+		}
+	}
+	for (const NumaNode& node: nodes_) {
+		for (const Core& c: node.cores()) {
+			if (c.owns(sensor)) {
+				return {SensorChip::ReadCost::Register, "cores"};
+			}
 		}
 	}
+	return {SensorChip::ReadCost::Register, "smn"};
 }
 
 Core::Core(
@@ -739,58 +814,54 @@ Core::Core(
 {
 }
 
-void Core::updateSensors() const
+bool Core::requestRegisters(const SensorChip::ChannelMask& sampled, std::vector<Ring0::MSRRead>& batch) const
 {
+	if (!sensors_.enabled(sampled, clock_) && !sensors_.enabled(sampled, multiplier_) &&
+	    !sensors_.enabled(sampled, power_) && !sensors_.enabled(sampled, vcore_)) {
+		return false;
+	}
+
 	// CPUID cpu = threads.FirstOrDefault();
 	const auto cpu = threads_[0];
 	if (!cpu) { // TODO seems impossible
-		return;
+		return false;
 	}
 
-	int curCpuVid;
-	int curCpuDfsId;
-	int curCpuFid;
-	unsigned totalEnergy;
+	// MSRC001_029A
+	// total_energy [31:0]
+	batch.push_back({MSR_CORE_ENERGY_STAT, cpu->affinity(), {0}, false});
+	// MSRC001_0293
+	// CurHwPstate [24:22]
+	// CurCpuVid [21:14]
+	// CurCpuDfsId [13:8]
+	// CurCpuFid [7:0]
+	batch.push_back({MSR_HARDWARE_PSTATE_STATUS, cpu->affinity(), {0}, false});
+	return true;
+}
 
-	const auto sampleTime = std::chrono::steady_clock::now();
-	auto& ring0 = Ring0::instance();
-	{
-		wm_sensors::impl::ThreadGroupAffinityGuard affinityLock{cpu->affinity()};
-
-		// MSRC001_0299
-		// TU [19:16]
-		// ESU [12:8] -> Unit 15.3 micro Joule per increment
-		// PU [3:0]
-		Ring0::MSRValue tmpMSR;
-		ring0.readMSR(MSR_PWR_UNIT, tmpMSR);
-
-		// MSRC001_029A
-		// total_energy [31:0]
-		ring0.readMSR(MSR_CORE_ENERGY_STAT, tmpMSR);
-		totalEnergy = tmpMSR.reg.eax;
-
-		// MSRC001_0293
-		// CurHwPstate [24:22]
-		// CurCpuVid [21:14]
-		// CurCpuDfsId [13:8]
-		// CurCpuFid [7:0]
-		ring0.readMSR(MSR_HARDWARE_PSTATE_STATUS, tmpMSR);
-		curCpuVid = (int)((tmpMSR.reg.eax >> 14) & 0xff);
-		curCpuDfsId = (int)((tmpMSR.reg.eax >> 8) & 0x3f);
-		curCpuFid = (int)(tmpMSR.reg.eax & 0xff);
-
-		// MSRC001_0064 + x
-		// IddDiv [31:30]
-		// IddValue [29:22]
-		// CpuVid [21:14]
-		// CpuDfsId [13:8]
-		// CpuFid [7:0]
-		// Ring0.ReadMsr(MSR_PSTATE_0 + (uint)CurHwPstate, out eax, out edx);
-		// int IddDiv = (int)((eax >> 30) & 0x03);
-		// int IddValue = (int)((eax >> 22) & 0xff);
-		// int CpuVid = (int)((eax >> 14) & 0xff);
+void Core::updateSensors(const Ring0::MSRRead* registers, std::chrono::steady_clock::time_point sampleTime) const
+{
+	if (!registers[0].succeeded || !registers[1].succeeded) {
+		return;
 	}
 
+	const unsigned totalEnergy = registers[0].value.reg.eax;
+	const u32 pstateStatus = registers[1].value.reg.eax;
+	const int curCpuVid = (int)((pstateStatus >> 14) & 0xff);
+	const int curCpuDfsId = (int)((pstateStatus >> 8) & 0x3f);
+	const int curCpuFid = (int)(pstateStatus & 0xff);
+
+	// MSRC001_0064 + x
+	// IddDiv [31:30]
+	// IddValue [29:22]
+	// CpuVid [21:14]
+	// CpuDfsId [13:8]
+	// CpuFid [7:0]
+	// Ring0.ReadMsr(MSR_PSTATE_0 + (uint)CurHwPstate, out eax, out edx);
+	// int IddDiv = (int)((eax >> 30) & 0x03);
+	// int IddValue = (int)((eax >> 22) & 0xff);
+	// int CpuVid = (int)((eax >> 14) & 0xff);
+
 	// clock
 	// CoreCOF is (Core::X86::Msr::PStateDef[CpuFid[7:0]] / Core::X86::Msr::PStateDef[CpuDfsId]) * 200
 	double clock = 200.0;
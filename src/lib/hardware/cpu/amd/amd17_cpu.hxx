@@ -20,6 +20,8 @@ namespace wm_sensors::hardware::cpu {
 		Config config() const override;
 		int read(SensorType type, u32 attr, std::size_t channel, double& val) const override;
 		int read(SensorType type, u32 attr, std::size_t channel, std::string_view& str) const override;
+		RefreshDomain refreshDomain() const override;
+		ChannelCost readCost(SensorType type, std::size_t channel) const override;
 #if 0
 	protected
 		override uint[] GetMsrs()
@@ -38,6 +40,11 @@ namespace wm_sensors::hardware::cpu {
 
 #endif
 
+	protected:
+		const std::atomic<double>* valueSlot(SensorType type, u32 attr, std::size_t channel) const override;
+		void refreshSensors() const override;
+		void publishValues() const override;
+
 	private:
 		DELETE_COPY_CTOR_AND_ASSIGNMENT(Amd17Cpu)
 
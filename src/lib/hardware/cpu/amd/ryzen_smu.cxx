@@ -255,7 +255,8 @@ wm_sensors::hardware::cpu::RyzenSMU::RyzenSMU(u32 family, u32 model, u32 package
 	if (supportedCPU_) {
 		// InpOut.Open();
 
-		setupPmTableAddrAndSize();
+		// the table layout depends on the version, DRAM address is set up on the first pmTable() call
+		setupPmTableSize();
 	}
 }
 
@@ -267,7 +268,7 @@ wm_sensors::hardware::cpu::RyzenSMU::pmTableStructure() const
 
 std::vector<float> wm_sensors::hardware::cpu::RyzenSMU::pmTable()
 {
-	if (!supportedCPU_ || !transferTableToDRAM())
+	if (!supportedCPU_ || !setupPmTableAddrAndSize() || !transferTableToDRAM())
 		return {0.f};
 
 	std::vector<float> table = readDRAMToArray();
@@ -4,6 +4,9 @@
 
 #include "../../impl/group_affinity.hxx"
 #include "../../utility/string.hxx"
+#include "../impl/pinned_samplers.hxx"
+#include "../impl/probe_cache.hxx"
+#include "../impl/ring0.hxx"
 
 #include <fmt/format.h>
 #include <spdlog/spdlog.h>
@@ -13,7 +16,9 @@
 #include <intrin.h>
 #include <powerbase.h>
 
+#include <cerrno>
 #include <cmath>
+#include <cstdlib>
 #include <limits>
 
 #if 0
@@ -32,7 +37,11 @@ static Identifier CreateIdentifier(Vendor vendor, int processorIndex)
 #endif
 
 namespace {
-	const auto frequencyUpdatePeriod = std::chrono::seconds(1);
+	std::string tscFrequencyCacheKey(unsigned processorIndex)
+	{
+		return fmt::format("cpu/{}/tsc-frequency", processorIndex);
+	}
+
 	struct PROCESSOR_POWER_INFORMATION {
 		ULONG Number;
 		ULONG MaxMhz;
@@ -43,8 +52,12 @@ namespace {
 	};
 	const LONG STATUS_ACCESS_DENIED = 0xC0000022;
 	const LONG STATUS_BUFFER_TOO_SMALL = 0xC0000023;
+
+	const wm_sensors::u32 IA32_MPERF = 0xE7;
+	const wm_sensors::u32 IA32_APERF = 0xE8;
 } // namespace
 
+
 wm_sensors::hardware::cpu::GenericCPU::GenericCPU(unsigned processorIndex, CpuIdDataArray&& cpuId)
     : base{{cpuId[0][0].name(), "cpu", BusType::ISA}}
     , cpuIdData_{std::move(cpuId)}
@@ -62,9 +75,20 @@ wm_sensors::hardware::cpu::GenericCPU::GenericCPU(unsigned processorIndex, CpuId
     , hasTimeStampCounter_{cpuIdData_[0][0].data().size() > 1 && (cpuIdData_[0][0].data()[1][3] & 0x10) != 0}
     // check if processor has a TSC
     , isInvariantTimeStampCounter_{cpuIdData_[0][0].data().size() > 7 && (cpuIdData_[0][0].data()[7][3] & 0x100) != 0}
-    , coreFrequencies_(coreCount_, 0)
     // check if processor supports an invariant TSC
+    , hasAperfMperf_{hasModelSpecificRegisters_ && hasTimeStampCounter_ && cpuIdData_[0][0].data().size() > 6 &&
+                     (cpuIdData_[0][0].data()[6][2] & 0x1) != 0}
+    // check if processor has the hardware coordination feedback capability (APERF and MPERF)
+    , coreSampled_(coreCount_, true)
+    , idleRefreshes_(coreCount_, std::numeric_limits<unsigned>::max()) // idle cores are read on the first refresh
+    , coreFrequencies_(coreCount_, std::numeric_limits<double>::quiet_NaN())
+    , effectiveClocks_(hasAperfMperf_ ? coreCount_ : 0, std::numeric_limits<double>::quiet_NaN())
+    , lastAperf_(effectiveClocks_.size(), 0)
+    , lastMperf_(effectiveClocks_.size(), 0)
+    , haveCounters_(effectiveClocks_.size(), 0)
     , lastTime_{0}
+    , idleLoadThreshold_{0.}
+    , idleInterval_{0}
 {
 	coreLabels_.reserve(coreCount_);
 	for (std::size_t i = 0; i < coreCount_; ++i) {
@@ -72,18 +96,59 @@ wm_sensors::hardware::cpu::GenericCPU::GenericCPU(unsigned processorIndex, CpuId
 	}
 
 	if (cpuLoad_.available()) {
-		coreLoads_.resize(coreCount_ + 1);
+		coreLoads_.resize(coreCount_ + 1, std::numeric_limits<double>::quiet_NaN());
+		channels_.add(SensorType::load, attributes::load_input | attributes::load_label, "CPU Total", &coreLoads_[0]);
+		for (std::size_t i = 0; i < coreCount_; ++i) {
+			channels_.add(SensorType::load, attributes::load_input | attributes::load_label, coreLabels_[i],
+			    &coreLoads_[i + 1]);
+		}
+	}
+
+	// MSR and OS counters are cheap to sample
+	channels_.addChip(0, std::chrono::milliseconds(250));
+
+	coreFrequencyChannel_ = channels_.channelCount(SensorType::frequency);
+	for (std::size_t i = 0; i < coreCount_; ++i) {
+		// frequencies are reported in MHz by the OS
+		channels_.add(SensorType::frequency, attributes::frequency_input | attributes::frequency_label, coreLabels_[i],
+		    &coreFrequencies_[i], 1e6);
+	}
+
+	effectiveClockChannel_ = channels_.channelCount(SensorType::frequency);
+	for (std::size_t i = 0; i < effectiveClocks_.size(); ++i) {
+		channels_.add(SensorType::frequency, attributes::frequency_input | attributes::frequency_label,
+		    coreLabels_[i] + " Effective", &effectiveClocks_[i], 1e6);
 	}
 
+	// the time stamp counter is calibrated by initialize()
+	estimatedTimeStampCounterFrequency_ = 0;
+	estimatedTimeStampCounterFrequencyError_ = 0;
+	timeStampCounterFrequency_ = 0;
+}
+
+void wm_sensors::hardware::cpu::GenericCPU::initialize() const
+{
 	if (hasTimeStampCounter_) {
-		impl::ThreadGroupAffinityGuard guard{cpuIdData_[0][0].affinity()};
-		estimateTimeStampCounterFrequency(
-		    estimatedTimeStampCounterFrequency_, estimatedTimeStampCounterFrequencyError_);
+		hardware::impl::PinnedSamplers::runOn(cpuIdData_[0][0].affinity(), [this] {
+			if (!cachedTimeStampCounterFrequency(
+			        estimatedTimeStampCounterFrequency_, estimatedTimeStampCounterFrequencyError_)) {
+				estimateTimeStampCounterFrequency(
+				    estimatedTimeStampCounterFrequency_, estimatedTimeStampCounterFrequencyError_);
+				// frequency of a variant TSC depends on the current core clock
+				if (isInvariantTimeStampCounter_ && estimatedTimeStampCounterFrequencyError_ < 1e-4) {
+					hardware::impl::ProbeCache::instance().set(
+					    tscFrequencyCacheKey(index_), fmt::format("{}", estimatedTimeStampCounterFrequency_));
+				}
+			}
+		});
 	} else {
 		estimatedTimeStampCounterFrequency_ = 0;
 	}
 
 	timeStampCounterFrequency_ = estimatedTimeStampCounterFrequency_;
+
+	effectiveClockReads_.reserve(2 * effectiveClocks_.size());
+	effectiveClockCores_.reserve(effectiveClocks_.size());
 }
 
 void wm_sensors::hardware::cpu::GenericCPU::update() const
@@ -91,109 +156,144 @@ void wm_sensors::hardware::cpu::GenericCPU::update() const
 	if (hasTimeStampCounter_ && isInvariantTimeStampCounter_) {
 		LARGE_INTEGER freq, firstTime, time;
 		u64 timeStampCount;
-		{
-			// make sure always the same thread is used
-			impl::ThreadGroupAffinityGuard guard{cpuIdData_[0][0].affinity()};
+		const auto readTimeStampCounter = [&] {
 			// read time before and after getting the TSC to estimate the error
 			::QueryPerformanceCounter(&firstTime);
 			timeStampCount = __rdtsc();
 			::QueryPerformanceCounter(&time);
-		}
+		};
+		// make sure always the same thread is used
+		hardware::impl::PinnedSamplers::runOn(cpuIdData_[0][0].affinity(), readTimeStampCounter);
 		::QueryPerformanceFrequency(&freq);
 		double delta = static_cast<double>(time.QuadPart - lastTime_) / static_cast<double>(freq.QuadPart);
 		double error = static_cast<double>(time.QuadPart - firstTime.QuadPart) / static_cast<double>(freq.QuadPart);
 
 		// only use data if they are measured accurate enough (max 0.1ms delay)
 		if (error < 0.0001) {
-			// ignore the first reading because there are no initial values
-			// ignore readings with too large or too small time window
-			if (lastTime_ != 0 && delta > 0.5 && delta < 2) {
+			// the first reading and readings after a too large time window only set the baseline, readings with a too
+			// small window keep it, so that the window grows over several refreshes
+			const bool baseline = lastTime_ == 0 || delta >= 2;
+			if (!baseline && delta > 0.5) {
 				// update the TSC frequency with the new value
 				timeStampCounterFrequency_ = static_cast<double>(timeStampCount - lastTimeStampCount_) / (1e6 * delta);
 			}
-
-			lastTimeStampCount_ = timeStampCount;
-			lastTime_ = time.QuadPart;
+			if (baseline || delta > 0.5) {
+				lastTimeStampCount_ = timeStampCount;
+				lastTime_ = time.QuadPart;
+			}
 		}
 	}
 
-	if (cpuLoad_.available()) {
+	// the idle sampling policy needs core loads regardless of the load channels
+	const bool loadsNeeded = (idleLoadThreshold_.load(std::memory_order_relaxed) > 0. &&
+	                          idleInterval_.load(std::memory_order_relaxed) > 1) ||
+	                         sampledChannels().any(SensorType::load, 0, channels_.channelCount(SensorType::load));
+	if (cpuLoad_.available() && loadsNeeded) {
+		ReadTimer timer{*this, "load"};
 		cpuLoad_.update();
 		coreLoads_[0] = cpuLoad_.totalLoad();
 		for (std::size_t i = 1; i < coreLoads_.size(); i++) {
 			coreLoads_[i] = cpuLoad_.coreLoad(i - 1);
 		}
 	}
+	updateCoreSampling(cpuLoad_.available() && loadsNeeded);
 }
 
-wm_sensors::SensorChip::Config wm_sensors::hardware::cpu::GenericCPU::config() const
+void wm_sensors::hardware::cpu::GenericCPU::updateCoreSampling(bool loadsUpdated) const
 {
-	Config res;
-	if (!coreLoads_.empty()) {
-		res.sensors[SensorType::load].channelAttributes.resize(
-		    coreLoads_.size(), attributes::load_input | attributes::load_label);
+	const double threshold = idleLoadThreshold_.load(std::memory_order_relaxed);
+	const unsigned interval = idleInterval_.load(std::memory_order_relaxed);
+	for (std::size_t i = 0; i < coreCount_; ++i) {
+		const bool idle = loadsUpdated && threshold > 0. && interval > 1 && cpuLoad_.coreLoad(i) < threshold;
+		coreSampled_[i] = !idle || idleRefreshes_[i] >= interval - 1;
+		idleRefreshes_[i] = coreSampled_[i] ? 0 : idleRefreshes_[i] + 1;
 	}
+}
 
-	res.sensors[SensorType::frequency].channelAttributes.resize(
-	    coreFrequencies_.size(), attributes::frequency_input | attributes::frequency_label);
-	return res;
+bool wm_sensors::hardware::cpu::GenericCPU::coreSampled(const CPUIDData& thread) const
+{
+	for (std::size_t i = 0; i < coreCount_; ++i) {
+		if (&cpuIdData_[i][0] == &thread) {
+			return coreSampled_[i];
+		}
+	}
+	return true;
 }
 
-int wm_sensors::hardware::cpu::GenericCPU::read(SensorType type, u32 attr, std::size_t channel, double& val) const
+void wm_sensors::hardware::cpu::GenericCPU::setIdleSampling(const IdleSampling& policy) const
 {
-	switch (type) {
-		case SensorType::frequency:
-			switch (attr) {
-				case attributes::frequency_input:
-					if (channel < coreFrequencies_.size()) {
-						maybeUpdateFrequencies();
-						val = coreFrequencies_[channel] * 1e6;
-						return 0;
-					}
-				default: break;
-			}
-		case SensorType::load:
-			switch (attr) {
-				case attributes::load_input:
-					if (channel < coreLoads_.size()) {
-						updateLoads();
-						val = coreLoads_[channel];
-						return 0;
-					}
-					break;
-				default: break;
-			}
-		default: break;
+	idleLoadThreshold_.store(policy.loadThreshold, std::memory_order_relaxed);
+	idleInterval_.store(policy.interval, std::memory_order_relaxed);
+}
+
+void wm_sensors::hardware::cpu::GenericCPU::refreshValues() const
+{
+	sampled_ = enabledChannels();
+	update();
+	if (sampledChannels().any(SensorType::frequency, coreFrequencyChannel_, coreCount_)) {
+		ReadTimer timer{*this, "frequency"};
+		updateFrequencies();
+	}
+	if (sampledChannels().any(SensorType::frequency, effectiveClockChannel_, effectiveClocks_.size())) {
+		updateEffectiveClocks();
+	}
+	refreshSensors();
+	publish([this] { publishValues(); });
+}
+
+void wm_sensors::hardware::cpu::GenericCPU::refreshSensors() const {}
+
+wm_sensors::SensorChip::RefreshDomain wm_sensors::hardware::cpu::GenericCPU::refreshDomain() const
+{
+	// MSRs are per core and the OS counters are not shared with other chips
+	return {BusType::Any, 0};
+}
+
+wm_sensors::SensorChip::ChannelCost
+wm_sensors::hardware::cpu::GenericCPU::readCost(SensorType type, std::size_t channel) const
+{
+	// loads and frequencies come from the OS
+	if (type == SensorType::load) {
+		return {ReadCost::Syscall, "load"};
+	}
+	if (type == SensorType::frequency && channel >= coreFrequencyChannel_ &&
+	    channel < coreFrequencyChannel_ + coreCount_) {
+		return {ReadCost::Syscall, "frequency"};
+	}
+	if (type == SensorType::frequency && channel >= effectiveClockChannel_ &&
+	    channel < effectiveClockChannel_ + effectiveClocks_.size()) {
+		return {ReadCost::Register, "aperf"};
 	}
-	return base::read(type, attr, channel, val);
+	return base::readCost(type, channel);
+}
+
+void wm_sensors::hardware::cpu::GenericCPU::publishValues() const
+{
+	channels_.publish(sampledChannels());
+}
+
+wm_sensors::SensorChip::Config wm_sensors::hardware::cpu::GenericCPU::config() const
+{
+	return channels_.config();
+}
+
+int wm_sensors::hardware::cpu::GenericCPU::read(SensorType type, u32 attr, std::size_t channel, double& val) const
+{
+	const int res = channels_.read(type, attr, channel, val);
+	return res == -ENOENT ? base::read(type, attr, channel, val) : res;
 }
 
 int wm_sensors::hardware::cpu::GenericCPU::read(
     SensorType type, u32 attr, std::size_t channel, std::string_view& str) const
 {
-	switch (type) {
-		case SensorType::frequency:
-			switch (attr) {
-				case attributes::frequency_label:
-					if (channel < coreFrequencies_.size()) {
-						str = coreLabels_[channel];
-						return 0;
-					}
-				default: break;
-			}
-		case SensorType::load:
-			switch (attr) {
-				case attributes::load_label:
-					if (channel < coreLoads_.size()) {
-						str = channel == 0 ? std::string_view("CPU Total") : std::string_view(coreLabels_[channel - 1]);
-						return 0;
-					}
-					break;
-				default: break;
-			}
-		default: break;
-	}
-	return base::read(type, attr, channel, str);
+	const int res = channels_.read(type, attr, channel, str);
+	return res == -ENOENT ? base::read(type, attr, channel, str) : res;
+}
+
+const std::atomic<double>*
+wm_sensors::hardware::cpu::GenericCPU::valueSlot(SensorType type, u32 attr, std::size_t channel) const
+{
+	return channels_.valueSlot(type, attr, channel);
 }
 
 std::string wm_sensors::hardware::cpu::GenericCPU::coreString(std::size_t i) const
@@ -201,7 +301,34 @@ std::string wm_sensors::hardware::cpu::GenericCPU::coreString(std::size_t i) con
 	return coreCount_ == 1 ? std::string{"CPU Core"} : fmt::format("CPU Core #{0}", i);
 }
 
-void wm_sensors::hardware::cpu::GenericCPU::estimateTimeStampCounterFrequency(double& frequency, double& error)
+bool wm_sensors::hardware::cpu::GenericCPU::cachedTimeStampCounterFrequency(double& frequency, double& error) const
+{
+	if (!isInvariantTimeStampCounter_) {
+		return false;
+	}
+	const auto cached = hardware::impl::ProbeCache::instance().get(tscFrequencyCacheKey(index_));
+	if (!cached) {
+		return false;
+	}
+	const double cachedFrequency = std::strtod(cached->c_str(), nullptr);
+	if (!std::isfinite(cachedFrequency) || cachedFrequency <= 0) {
+		return false;
+	}
+
+	// a single short measurement is enough to tell that the TSC runs at the cached frequency
+	double f, e;
+	estimateTimeStampCounterFrequency(0, f, e);
+	estimateTimeStampCounterFrequency(0.005, f, e);
+	if (std::abs(f - cachedFrequency) > cachedFrequency * (0.01 + e)) {
+		spdlog::info("Cached TSC frequency {} MHz does not match the measured {} MHz", cachedFrequency, f);
+		return false;
+	}
+	frequency = cachedFrequency;
+	error = 0;
+	return true;
+}
+
+void wm_sensors::hardware::cpu::GenericCPU::estimateTimeStampCounterFrequency(double& frequency, double& error) const
 {
 	// preload the function
 	double f, e;
@@ -258,32 +385,68 @@ void wm_sensors::hardware::cpu::GenericCPU::estimateTimeStampCounterFrequency(
 	error = beginError + endError;
 }
 
-void wm_sensors::hardware::cpu::GenericCPU::updateLoads() const
+void wm_sensors::hardware::cpu::GenericCPU::updateFrequencies() const
 {
-	LARGE_INTEGER freq, time;
-	::QueryPerformanceFrequency(&freq);
-	::QueryPerformanceCounter(&time);
-	if (time.QuadPart - lastTime_ > freq.QuadPart) {
-		this->update();
+	std::vector<PROCESSOR_POWER_INFORMATION> buf(logicalCoreCount_);
+	auto er = ::CallNtPowerInformation(
+	    ProcessorInformation, nullptr, 0, buf.data(), static_cast<ULONG>(buf.size() * sizeof(PROCESSOR_POWER_INFORMATION)));
+	if (er == 0) {
+		for (std::size_t i = 0; i < coreCount_; ++i) {
+			coreFrequencies_[i] = static_cast<double>(buf[i * logicalCoreCount_ / coreCount_].CurrentMhz);
+		}
+	} else if (er == STATUS_BUFFER_TOO_SMALL) {
+		spdlog::error("CallNtPowerInformation() error: buffer too small");
+	} else if (er == STATUS_ACCESS_DENIED) {
+		spdlog::error("CallNtPowerInformation() error: access denied");
 	}
 }
 
-void wm_sensors::hardware::cpu::GenericCPU::maybeUpdateFrequencies() const
+void wm_sensors::hardware::cpu::GenericCPU::updateEffectiveClocks() const
 {
-	const auto now = std::chrono::steady_clock::now();
-	if (now - lastUpdateFreq_ > frequencyUpdatePeriod) {
-		std::vector<PROCESSOR_POWER_INFORMATION> buf(logicalCoreCount_);
-		auto er = ::CallNtPowerInformation(
-		    ProcessorInformation, nullptr, 0, buf.data(), static_cast<ULONG>(buf.size() * sizeof(PROCESSOR_POWER_INFORMATION)));
-		if (er == 0) {
-			for (std::size_t i = 0; i < coreCount_; ++i) {
-				coreFrequencies_[i] = buf[i * logicalCoreCount_ / coreCount_].CurrentMhz;
-			}
-			lastUpdateFreq_ = now;
-		} else if (er == STATUS_BUFFER_TOO_SMALL) {
-			spdlog::error("CallNtPowerInformation() error: buffer too small");
-		} else if (er == STATUS_ACCESS_DENIED) {
-			spdlog::error("CallNtPowerInformation() error: access denied");
+	// both counters of a core are read on its first thread, idle cores keep their values
+	auto& batch = effectiveClockReads_;
+	auto& cores = effectiveClockCores_;
+	batch.clear();
+	cores.clear();
+	for (std::size_t i = 0; i < effectiveClocks_.size(); ++i) {
+		if (!coreSampled(i) || !sampledChannels().test(SensorType::frequency, effectiveClockChannel_ + i)) {
+			continue;
+		}
+		const auto& affinity = cpuIdData_[i][0].affinity();
+		batch.push_back({IA32_APERF, affinity, {0}, false});
+		batch.push_back({IA32_MPERF, affinity, {0}, false});
+		cores.push_back(i);
+	}
+	if (batch.empty()) {
+		return;
+	}
+
+	{
+		ReadTimer timer{*this, "aperf"};
+		hardware::impl::Ring0::instance().readMSRs(batch);
+	}
+
+	for (std::size_t j = 0; j < cores.size(); ++j) {
+		const std::size_t i = cores[j];
+		const auto& aperf = batch[2 * j];
+		const auto& mperf = batch[2 * j + 1];
+		if (!aperf.succeeded || !mperf.succeeded) {
+			effectiveClocks_[i] = std::numeric_limits<double>::quiet_NaN();
+			continue;
+		}
+
+		// unsigned differences are correct across a wrap of the 64-bit counters, the first read is the baseline
+		const u64 deltaAperf = aperf.value.value - lastAperf_[i];
+		const u64 deltaMperf = mperf.value.value - lastMperf_[i];
+		const bool baseline = !haveCounters_[i];
+		lastAperf_[i] = aperf.value.value;
+		lastMperf_[i] = mperf.value.value;
+		haveCounters_[i] = 1;
+
+		// MPERF counts at the TSC rate while the core is in C0, a core which slept through the interval keeps its value
+		if (!baseline && deltaMperf != 0) {
+			effectiveClocks_[i] =
+			    static_cast<double>(deltaAperf) / static_cast<double>(deltaMperf) * timeStampCounterFrequency_;
 		}
 	}
 }
@@ -5,8 +5,11 @@
 
 #include "./cpuid.hxx"
 
+#include "../../impl/channel_table.hxx"
 #include "../../sensor.hxx"
+#include "../impl/ring0.hxx"
 
+#include <atomic>
 #include <chrono>
 
 #include "cpu_load.hxx"
@@ -46,11 +49,57 @@ namespace wm_sensors::hardware::cpu {
 			return timeStampCounterFrequency_;
 		}
 
+		/** Reduced sampling of idle cores */
+		struct IdleSampling {
+			double loadThreshold; // cores with a lower load (0..1) are idle, 0 disables the policy
+			unsigned interval;    // registers of an idle core are read on every interval-th refresh only, 0 and 1
+			                      // disable the policy
+		};
+
+		/** Set by the tree owning the chip from its options, may be changed between refreshes */
+		void setIdleSampling(const IdleSampling& policy) const;
+
 		Config config() const override;
 		int read(SensorType type, u32 attr, std::size_t channel, double& val) const override;
 		int read(SensorType type, u32 attr, std::size_t channel, std::string_view& str) const override;
+		RefreshDomain refreshDomain() const override;
+		ChannelCost readCost(SensorType type, std::size_t channel) const override;
 
 	protected:
+		/** Calibrates the time stamp counter */
+		void initialize() const override;
+		void refreshValues() const final override;
+		const std::atomic<double>* valueSlot(SensorType type, u32 attr, std::size_t channel) const override;
+
+		/** Reads model specific sensors, called by refresh() after the generic ones and before publishing */
+		virtual void refreshSensors() const;
+		/** Publishes values computed by refresh(), the default implementation publishes channels() */
+		virtual void publishValues() const;
+
+		/** Channels enabled for the refresh in progress, drivers skip reading disabled ones */
+		const ChannelMask& sampledChannels() const
+		{
+			return *sampled_;
+		}
+
+		/** Channels of this chip, derived classes append their own in their constructors */
+		wm_sensors::impl::ChannelTable& channels()
+		{
+			return channels_;
+		}
+
+		/**
+		 * Whether per-core registers of the core are read in the refresh in progress. Reading them wakes the core
+		 * from a deep C-state, so idle cores are read at a reduced rate and keep their values in between.
+		 */
+		bool coreSampled(std::size_t core) const
+		{
+			return coreSampled_[core];
+		}
+
+		/** Same for the core whose first thread is @p thread */
+		bool coreSampled(const CPUIDData& thread) const;
+
 		std::string coreString(std::size_t i) const;
 		std::size_t coreCount() const
 		{
@@ -95,11 +144,14 @@ namespace wm_sensors::hardware::cpu {
 	private:
 		DELETE_COPY_CTOR_AND_ASSIGNMENT(GenericCPU)
 
-		void estimateTimeStampCounterFrequency(double& frequency, double& error);
+		void estimateTimeStampCounterFrequency(double& frequency, double& error) const;
+		/** Returns the frequency stored in the probe cache if a short measurement confirms it */
+		bool cachedTimeStampCounterFrequency(double& frequency, double& error) const;
 		static void estimateTimeStampCounterFrequency(double timeWindow, double& frequency, double& error);
-		void updateLoads() const;
 		void update() const;
-		void maybeUpdateFrequencies() const;
+		void updateFrequencies() const;
+		void updateCoreSampling(bool loadsUpdated) const;
+		void updateEffectiveClocks() const;
 
 		// virtual uint[] GetMsrs()
 		//{
@@ -119,18 +171,36 @@ namespace wm_sensors::hardware::cpu {
 		const bool hasModelSpecificRegisters_;
 		const bool hasTimeStampCounter_;
 		const bool isInvariantTimeStampCounter_;
-
-		mutable std::vector<float> coreLoads_;
-		mutable std::vector<unsigned long> coreFrequencies_;
+		const bool hasAperfMperf_;
+
+		mutable std::vector<double> coreLoads_;
+		mutable std::vector<bool> coreSampled_;
+		mutable std::vector<unsigned> idleRefreshes_; // refreshes since the idle core was read
+		mutable std::vector<double> coreFrequencies_;
+		std::size_t coreFrequencyChannel_;
+		// average clocks while the cores were in C0 over the refresh interval, from IA32_APERF/IA32_MPERF deltas, in
+		// MHz. Time spent in sleep states does not lower them, unlike a wall-clock average.
+		mutable std::vector<double> effectiveClocks_;
+		mutable std::vector<u64> lastAperf_;
+		mutable std::vector<u64> lastMperf_;
+		mutable std::vector<u8> haveCounters_; // lastAperf_ and lastMperf_ hold a reading
+		// batch of the counter reads and the cores it covers, sized by initialize()
+		mutable std::vector<hardware::impl::Ring0::MSRRead> effectiveClockReads_;
+		mutable std::vector<std::size_t> effectiveClockCores_;
+		std::size_t effectiveClockChannel_;
+		mutable std::shared_ptr<const ChannelMask> sampled_;
+		wm_sensors::impl::ChannelTable channels_;
 
 		std::vector<std::string> coreLabels_;
-		double estimatedTimeStampCounterFrequency_;
-		double estimatedTimeStampCounterFrequencyError_;
+		mutable double estimatedTimeStampCounterFrequency_;
+		mutable double estimatedTimeStampCounterFrequencyError_;
 
 		mutable s64 lastTime_;
 		mutable u64 lastTimeStampCount_;
 		mutable double timeStampCounterFrequency_;
-		mutable std::chrono::steady_clock::time_point lastUpdateFreq_;
+
+		mutable std::atomic<double> idleLoadThreshold_;
+		mutable std::atomic<unsigned> idleInterval_;
 	};
 } // namespace wm_sensors::hardware::cpu
 
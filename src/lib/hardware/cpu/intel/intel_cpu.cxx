@@ -4,10 +4,12 @@
 
 #include "./intel_cpu.hxx"
 
+#include "../../../impl/group_affinity.hxx"
 #include "../../impl/ring0.hxx"
 
+#include <algorithm>
+#include <cmath>
 #include <limits>
-#include <thread>
 
 using wm_sensors::hardware::impl::Ring0;
 
@@ -29,14 +31,16 @@ namespace {
 
 	const u32 energyStatusMsrs[] = {
 	    MSR_PKG_ENERY_STATUS, MSR_PP0_ENERY_STATUS, MSR_PP1_ENERY_STATUS, MSR_DRAM_ENERGY_STATUS};
-
-	const std::chrono::seconds updateFreq{1};
 } // namespace
 
 wm_sensors::hardware::cpu::IntelCPU::IntelCPU(unsigned processorIndex, std::vector<std::vector<CPUIDData>>&& cpuId)
     : GenericCPU(processorIndex, std::move(cpuId))
-    , baseChannels_{base::config().nrChannels()}
-    , lastUpdate_{std::chrono::steady_clock::now() - 2 * updateFreq}
+    , tjMaxFromMsr_{false}
+    , timeStampCounterMultiplier_{0}
+    , coreTemperatureChannel_{0}
+    , packageTemperatureChannel_{0}
+    , coreMaxTemperatureChannel_{0}
+    , busClockChannel_{0}
 {
 	// set tjMax
 	std::vector<float> tjMax;
@@ -86,17 +90,17 @@ wm_sensors::hardware::cpu::IntelCPU::IntelCPU(unsigned processorIndex, std::vect
 				case 0x2E: // Intel Xeon Processor 7500 series (45nm)
 				case 0x2F: // Intel Xeon Processor (32nm)
 					microArchitecture_ = MicroArchitecture::Nehalem;
-					tjMax = tjsFromMSR();
+					tjMaxFromMsr_ = true;
 					break;
 				case 0x2A: // Intel Core i5, i7 2xxx LGA1155 (32nm)
 				case 0x2D: // Next Generation Intel Xeon, i7 3xxx LGA2011 (32nm)
 					microArchitecture_ = MicroArchitecture::SandyBridge;
-					tjMax = tjsFromMSR();
+					tjMaxFromMsr_ = true;
 					break;
 				case 0x3A: // Intel Core i5, i7 3xxx LGA1155 (22nm)
 				case 0x3E: // Intel Core i7 4xxx LGA2011 (22nm)
 					microArchitecture_ = MicroArchitecture::IvyBridge;
-					tjMax = tjsFromMSR();
+					tjMaxFromMsr_ = true;
 					break;
 				case 0x3C: // Intel Core i5, i7 4xxx LGA1150 (22nm)
 				case 0x3F: // Intel Xeon E5-2600/1600 v3, Core i7-59xx
@@ -104,18 +108,18 @@ wm_sensors::hardware::cpu::IntelCPU::IntelCPU(unsigned processorIndex, std::vect
 				case 0x45: // Intel Core i5, i7 4xxxU (22nm)
 				case 0x46:
 					microArchitecture_ = MicroArchitecture::Haswell;
-					tjMax = tjsFromMSR();
+					tjMaxFromMsr_ = true;
 					break;
 				case 0x3D: // Intel Core M-5xxx (14nm)
 				case 0x47: // Intel i5, i7 5xxx, Xeon E3-1200 v4 (14nm)
 				case 0x4F: // Intel Xeon E5-26xx v4
 				case 0x56: // Intel Xeon D-15xx
 					microArchitecture_ = MicroArchitecture::Broadwell;
-					tjMax = tjsFromMSR();
+					tjMaxFromMsr_ = true;
 					break;
 				case 0x36: // Intel Atom S1xxx, D2xxx, N2xxx (32nm)
 					microArchitecture_ = MicroArchitecture::Atom;
-					tjMax = tjsFromMSR();
+					tjMaxFromMsr_ = true;
 					break;
 				case 0x37: // Intel Atom E3xxx, Z3xxx (22nm)
 				case 0x4A:
@@ -123,68 +127,68 @@ wm_sensors::hardware::cpu::IntelCPU::IntelCPU(unsigned processorIndex, std::vect
 				case 0x5A:
 				case 0x5D:
 					microArchitecture_ = MicroArchitecture::Silvermont;
-					tjMax = tjsFromMSR();
+					tjMaxFromMsr_ = true;
 					break;
 				case 0x4E:
 				case 0x5E: // Intel Core i5, i7 6xxxx LGA1151 (14nm)
 				case 0x55: // Intel Core X i7, i9 7xxx LGA2066 (14nm)
 					microArchitecture_ = MicroArchitecture::Skylake;
-					tjMax = tjsFromMSR();
+					tjMaxFromMsr_ = true;
 					break;
 				case 0x4C: // Intel Airmont (Cherry Trail, Braswell)
 					microArchitecture_ = MicroArchitecture::Airmont;
-					tjMax = tjsFromMSR();
+					tjMaxFromMsr_ = true;
 					break;
 				case 0x8E: // Intel Core i5, i7 7xxxx (14nm) (Kaby Lake) and 8xxxx (14nm++) (Coffee Lake)
 				case 0x9E:
 					microArchitecture_ = MicroArchitecture::KabyLake;
-					tjMax = tjsFromMSR();
+					tjMaxFromMsr_ = true;
 					break;
 				case 0x5C: // Goldmont (Apollo Lake)
 				case 0x5F: // (Denverton)
 					microArchitecture_ = MicroArchitecture::Goldmont;
-					tjMax = tjsFromMSR();
+					tjMaxFromMsr_ = true;
 					break;
 				case 0x7A: // Goldmont plus (Gemini Lake)
 					microArchitecture_ = MicroArchitecture::GoldmontPlus;
-					tjMax = tjsFromMSR();
+					tjMaxFromMsr_ = true;
 					break;
 				case 0x66: // Intel Core i3 8xxx (10nm) (Cannon Lake)
 					microArchitecture_ = MicroArchitecture::CannonLake;
-					tjMax = tjsFromMSR();
+					tjMaxFromMsr_ = true;
 					break;
 				case 0x7D: // Intel Core i3, i5, i7 10xxx (10nm) (Ice Lake)
 				case 0x7E:
 				case 0x6A: // Ice Lake server
 				case 0x6C:
 					microArchitecture_ = MicroArchitecture::IceLake;
-					tjMax = tjsFromMSR();
+					tjMaxFromMsr_ = true;
 					break;
 				case 0xA5:
 				case 0xA6: // Intel Core i3, i5, i7 10xxxU (14nm)
 					microArchitecture_ = MicroArchitecture::CometLake;
-					tjMax = tjsFromMSR();
+					tjMaxFromMsr_ = true;
 					break;
 				case 0x86: // Tremont (10nm) (Elkhart Lake, Skyhawk Lake)
 					microArchitecture_ = MicroArchitecture::Tremont;
-					tjMax = tjsFromMSR();
+					tjMaxFromMsr_ = true;
 					break;
 				case 0x8C: // Tiger Lake (10nm)
 				case 0x8D:
 					microArchitecture_ = MicroArchitecture::TigerLake;
-					tjMax = tjsFromMSR();
+					tjMaxFromMsr_ = true;
 					break;
 				case 0x97: // Alder Lake (7nm)
 					microArchitecture_ = MicroArchitecture::AlderLake;
-					tjMax = tjsFromMSR();
+					tjMaxFromMsr_ = true;
 					break;
 				case 0x9C: // Jasper Lake (10nm)
 					microArchitecture_ = MicroArchitecture::JasperLake;
-					tjMax = tjsFromMSR();
+					tjMaxFromMsr_ = true;
 					break;
 				case 0xA7: // Intel Core i5, i6, i7 11xxx (14nm) (Rocket Lake)
 					microArchitecture_ = MicroArchitecture::RocketLake;
-					tjMax = tjsFromMSR();
+					tjMaxFromMsr_ = true;
 					break;
 				default:
 					microArchitecture_ = MicroArchitecture::Unknown;
@@ -214,43 +218,9 @@ wm_sensors::hardware::cpu::IntelCPU::IntelCPU(unsigned processorIndex, std::vect
 			tjMax = std::vector<float>(coreCount(), 100);
 			break;
 	}
-	// set timeStampCounterMultiplier
-	switch (microArchitecture_) {
-		case MicroArchitecture::Atom:
-		case MicroArchitecture::Core:
-		case MicroArchitecture::NetBurst: {
-			u32 eax, edx;
-			if (Ring0::instance().readMSR(IA32_PERF_STATUS, eax, edx)) {
-				timeStampCounterMultiplier_ = ((edx >> 8) & 0x1f) + 0.5 * ((edx >> 14) & 1);
-			}
-
-			break;
-		}
-		case MicroArchitecture::Airmont:
-		case MicroArchitecture::AlderLake:
-		case MicroArchitecture::Broadwell:
-		case MicroArchitecture::CannonLake:
-		case MicroArchitecture::CometLake:
-		case MicroArchitecture::Goldmont:
-		case MicroArchitecture::GoldmontPlus:
-		case MicroArchitecture::Haswell:
-		case MicroArchitecture::IceLake:
-		case MicroArchitecture::IvyBridge:
-		case MicroArchitecture::JasperLake:
-		case MicroArchitecture::KabyLake:
-		case MicroArchitecture::Nehalem:
-		case MicroArchitecture::RocketLake:
-		case MicroArchitecture::SandyBridge:
-		case MicroArchitecture::Silvermont:
-		case MicroArchitecture::Skylake:
-		case MicroArchitecture::TigerLake:
-		case MicroArchitecture::Tremont: {
-			u32 eax, edx;
-			if (Ring0::instance().readMSR(MSR_PLATFORM_INFO, eax, edx)) {
-				timeStampCounterMultiplier_ = (eax >> 8) & 0xff;
-			}
-		} break;
-		default: timeStampCounterMultiplier_ = 0; break;
+	if (tjMaxFromMsr_) {
+		// replaced with values read by initialize()
+		tjMax = std::vector<float>(coreCount(), 100);
 	}
 
 	// check if processor supports a digital thermal sensor at core level
@@ -258,17 +228,23 @@ wm_sensors::hardware::cpu::IntelCPU::IntelCPU(unsigned processorIndex, std::vect
 		coreTemperatures_.reserve(coreCount());
 		for (std::size_t i = 0; i < coreCount(); i++) {
 			coreTemperatures_.push_back({tjMax[i], 1., 0.});
-			temperatureLabels_.push_back(coreString(i));
 		}
+		coreTemperatureChannel_ = channels().channelCount(SensorType::temp);
 		for (std::size_t i = 0; i < coreCount(); i++) {
-			temperatureLabels_.push_back(coreString(i) + " distance to TjMax");
+			channels().add(SensorType::temp, attributes::temp_input | attributes::temp_label, coreString(i),
+			    &coreTemperatures_[i].value);
+		}
+		for (std::size_t i = 0; i < coreCount(); i++) {
+			channels().add(SensorType::temp, attributes::temp_input | attributes::temp_label,
+			    coreString(i) + " distance to TjMax", &coreTemperatures_[i].deltaT);
 		}
 	}
 
 	// check if processor supports a digital thermal sensor at package level
 	if ((cpu0IdData().safeData(6, 0, 0) & 0x40) != 0 && microArchitecture_ != MicroArchitecture::Unknown) {
 		packageTemperature_ = {tjMax[0], 1., 0.};
-		temperatureLabels_.emplace_back("CPU Package");
+		packageTemperatureChannel_ = channels().add(SensorType::temp, attributes::temp_input | attributes::temp_label, "CPU Package",
+		    &packageTemperature_->value);
 	}
 
 #if 0
@@ -291,17 +267,22 @@ wm_sensors::hardware::cpu::IntelCPU::IntelCPU(unsigned processorIndex, std::vect
 	if ((cpu0IdData().safeData(6, 0, 0) & 0x40) != 0 && microArchitecture_ != MicroArchitecture::Unknown &&
 	    coreCount() > 1) {
 		coreMaxTemperature_ = 0.;
-		temperatureLabels_.emplace_back("Core Max");
+		coreMaxTemperatureChannel_ = channels().add(SensorType::temp, attributes::temp_input | attributes::temp_label, "Core Max",
+		    &coreMaxTemperature_.value());
 		coreAvgTemperature_ = 0.;
-		temperatureLabels_.emplace_back("Core Average");
+		channels().add(SensorType::temp, attributes::temp_input | attributes::temp_label, "Core Average",
+		    &coreAvgTemperature_.value());
 	}
 
 	if (hasTimeStampCounter() && microArchitecture_ != MicroArchitecture::Unknown) {
-		frequencyLabels_.emplace_back("Bus Speed");
-		busClock_ = 0.;
-		coreClocks_.resize(coreCount(), 0.f);
+		busClock_ = std::numeric_limits<double>::quiet_NaN();
+		coreClocks_.resize(coreCount(), std::numeric_limits<double>::quiet_NaN());
+		// clocks are computed in MHz
+		busClockChannel_ = channels().add(SensorType::frequency,
+		    attributes::frequency_input | attributes::frequency_label, "Bus Speed", &busClock_.value(), 1e6);
 		for (std::size_t i = 0; i < coreCount(); i++) {
-			frequencyLabels_.emplace_back(coreString(i));
+			channels().add(SensorType::frequency, attributes::frequency_input | attributes::frequency_label,
+			    coreString(i), &coreClocks_[i], 1e6);
 		}
 	}
 
@@ -328,7 +309,8 @@ wm_sensors::hardware::cpu::IntelCPU::IntelCPU(unsigned processorIndex, std::vect
 		}
 
 		if (energyUnitMultiplier_ != 0) {
-			powerSensors_.resize(utility::array_size(energyStatusMsrs), std::numeric_limits<float>::quiet_NaN());
+			powerSensors_.resize(utility::array_size(energyStatusMsrs), std::numeric_limits<double>::quiet_NaN());
+			powerChannels_.resize(utility::array_size(energyStatusMsrs));
 			lastEnergyTime_.resize(utility::array_size(energyStatusMsrs));
 			lastEnergyConsumed_.resize(utility::array_size(energyStatusMsrs));
 
@@ -339,265 +321,278 @@ wm_sensors::hardware::cpu::IntelCPU::IntelCPU(unsigned processorIndex, std::vect
 					continue;
 				}
 
-				powerLabels_.emplace_back(powerSensorLabels[i]);
+				powerChannels_[i] = channels().add(SensorType::power,
+				    attributes::power_input | attributes::power_label, powerSensorLabels[i], &powerSensors_[i]);
 				lastEnergyTime_[i] = std::chrono::steady_clock::now();
 				lastEnergyConsumed_[i] = eax;
 				powerSensors_[i] = 0.;
 			}
 		}
 	}
-
-	update();
 }
 
-wm_sensors::SensorChip::Config wm_sensors::hardware::cpu::IntelCPU::config() const
+void wm_sensors::hardware::cpu::IntelCPU::initialize() const
 {
-	Config res = base::config();
-	res.appendChannels(SensorType::temp, temperatureLabels_.size(), attributes::temp_input | attributes::temp_label);
-	res.appendChannels(
-	    SensorType::frequency, frequencyLabels_.size(), attributes::frequency_input | attributes::frequency_label);
-	res.appendChannels(SensorType::power, powerLabels_.size(), attributes::power_input | attributes::power_label);
+	base::initialize();
 
-	return res;
-}
-
-int wm_sensors::hardware::cpu::IntelCPU::read(SensorType type, u32 attr, std::size_t channel, double& val) const
-{
-	std::size_t myChannel;
-	
-	if (Config::isInRange(baseChannels_, type, channel, &myChannel)) {
-		if (std::chrono::steady_clock::now() > lastUpdate_ + updateFreq) {
-			this->update();
+	if (tjMaxFromMsr_) {
+		const std::vector<float> tjMax = tjsFromMSR();
+		for (std::size_t i = 0; i < coreTemperatures_.size(); i++) {
+			coreTemperatures_[i].tjMax = tjMax[i];
 		}
-		const auto optionallyRead = [&myChannel, &val](const std::optional<double>& o) -> bool {
-			if (o.has_value()) {
-				if (myChannel == 0) {
-					val = o.value();
-					return true;
-				} else {
-					--myChannel;
-					return false;
-				}
-			}
-			return false;
-		};
-
-		switch (type) {
-			case SensorType::temp:
-				// order: coreTemperatures_(value),temperatureLabels_(delta), packageTemperature_, coreMaxTemperature_, coreAvgTemperature_
-				if (myChannel < coreTemperatures_.size()) {
-					val = coreTemperatures_[myChannel].value;
-					return 0;
-				} else {
-					myChannel -= coreTemperatures_.size();
-				}
-				if (myChannel < coreTemperatures_.size()) {
-					val = coreTemperatures_[myChannel].deltaT;
-					return 0;
-				} else {
-					myChannel -= coreTemperatures_.size();
-				}
-				if (packageTemperature_.has_value()) {
-					if (myChannel == 0 ) {
-						val = packageTemperature_.value().value;
-						return 0;
-					} else {
-						--myChannel;
-					}
-				}
-				if (optionallyRead(coreMaxTemperature_)) {
-					return 0;
-				}
-				if (optionallyRead(coreAvgTemperature_)) {
-					return 0;
-				}
-				return -EOPNOTSUPP;
-			case SensorType::frequency:
-				// order: busClock_, coreClocks_
-				if (optionallyRead(busClock_)) {
-					return 0;
-				}
-				if (myChannel < coreClocks_.size()) {
-					val = coreClocks_[myChannel] * 1e6;
-					return 0;
-				} else {
-					myChannel -= coreClocks_.size();
-				}
-				return -EOPNOTSUPP;
-			case SensorType::power:
-				// order: 
-				for (std::size_t i = 0; i < powerSensors_.size(); ++i) {
-					if (!std::isnan(powerSensors_[i])) {
-						if (myChannel == 0) {
-							val = powerSensors_[i];
-							return 0;
-						} else {
-							--myChannel;
-						}
-					}
-				}
-				return -EOPNOTSUPP;
-			default: return -EOPNOTSUPP;
+		if (packageTemperature_.has_value()) {
+			packageTemperature_->tjMax = tjMax[0];
 		}
 	}
-	return base::read(type, attr, channel, val);
-}
 
-int wm_sensors::hardware::cpu::IntelCPU::read(
-    SensorType type, u32 attr, std::size_t channel, std::string_view& str) const
-{
-	std::size_t myChannel;
-
-	if (Config::isInRange(baseChannels_, type, channel, &myChannel)) {
-		switch (type) {
-			case SensorType::temp:
-				if (myChannel < temperatureLabels_.size()) {
-					str = temperatureLabels_[myChannel];
-					return 0;
-				}
-				return -EOPNOTSUPP;
-			case SensorType::frequency:
-				if (myChannel < frequencyLabels_.size()) {
-					str = frequencyLabels_[myChannel];
-					return 0;
-				}
-				return -EOPNOTSUPP;
-			case SensorType::power:
-				if (myChannel < powerLabels_.size()) {
-					str = powerLabels_[myChannel];
-					return 0;
-				}
-				return -EOPNOTSUPP;
-			default: return -EOPNOTSUPP;
+	// set timeStampCounterMultiplier
+	switch (microArchitecture_) {
+		case MicroArchitecture::Atom:
+		case MicroArchitecture::Core:
+		case MicroArchitecture::NetBurst: {
+			u32 eax, edx;
+			if (Ring0::instance().readMSR(IA32_PERF_STATUS, eax, edx, cpu0IdData().affinity())) {
+				timeStampCounterMultiplier_ = ((edx >> 8) & 0x1f) + 0.5 * ((edx >> 14) & 1);
+			}
+
+			break;
 		}
+		case MicroArchitecture::Airmont:
+		case MicroArchitecture::AlderLake:
+		case MicroArchitecture::Broadwell:
+		case MicroArchitecture::CannonLake:
+		case MicroArchitecture::CometLake:
+		case MicroArchitecture::Goldmont:
+		case MicroArchitecture::GoldmontPlus:
+		case MicroArchitecture::Haswell:
+		case MicroArchitecture::IceLake:
+		case MicroArchitecture::IvyBridge:
+		case MicroArchitecture::JasperLake:
+		case MicroArchitecture::KabyLake:
+		case MicroArchitecture::Nehalem:
+		case MicroArchitecture::RocketLake:
+		case MicroArchitecture::SandyBridge:
+		case MicroArchitecture::Silvermont:
+		case MicroArchitecture::Skylake:
+		case MicroArchitecture::TigerLake:
+		case MicroArchitecture::Tremont: {
+			u32 eax, edx;
+			if (Ring0::instance().readMSR(MSR_PLATFORM_INFO, eax, edx, cpu0IdData().affinity())) {
+				timeStampCounterMultiplier_ = (eax >> 8) & 0xff;
+			}
+		} break;
+		default: timeStampCounterMultiplier_ = 0; break;
 	}
-	return base::read(type, attr, channel, str);
 }
 
-void wm_sensors::hardware::cpu::IntelCPU::update() const
+void wm_sensors::hardware::cpu::IntelCPU::refreshSensors() const
 {
-	double coreMax = std::numeric_limits<float>::min();
-	double coreAvg = 0.f;
-
-	for (std::size_t i = 0; i < coreTemperatures_.size(); i++) {
-		// if reading is valid
-		u32 eax, edx;
+	const ChannelMask& sampled = sampledChannels();
+
+	// max and average need all cores
+	const bool coreAggregatesSampled =
+	    coreMaxTemperature_.has_value() && sampled.any(SensorType::temp, coreMaxTemperatureChannel_, 2);
+	const bool clocksSampled = hasTimeStampCounter() && timeStampCounterMultiplier_ > 0 &&
+	                           sampled.any(SensorType::frequency, busClockChannel_, coreClocks_.size() + 1);
+	const bool busClockSampled = clocksSampled && sampled.test(SensorType::frequency, busClockChannel_);
+	const double busClock = clocksSampled ? timeStampCounterFrequency() / timeStampCounterMultiplier_ : 0.;
+
+	// collect all register reads into a single batch, which visits each core once
+	enum class Target
+	{
+		CoreTemperature,
+		CoreClock,
+		PackageTemperature,
+		Energy
+	};
+	std::vector<Ring0::MSRRead> batch;
+	std::vector<std::pair<Target, std::size_t>> targets;
+	const auto request = [&](u32 msr, const wm_sensors::impl::GroupAffinity& affinity, Target target, std::size_t i) {
+		batch.push_back({msr, affinity, {0}, false});
+		targets.emplace_back(target, i);
+	};
+
+	// idle cores are skipped and keep their values, the package registers cover them
+	bool busClockRequested = false;
+	for (std::size_t i = 0; i < coreCount(); ++i) {
+		if (!coreSampled(i)) {
+			continue;
+		}
+		const auto& affinity = cpuIdData()[i][0].affinity();
+		if (i < coreTemperatures_.size() &&
+		    (coreAggregatesSampled || sampled.test(SensorType::temp, coreTemperatureChannel_ + i) ||
+		     sampled.test(SensorType::temp, coreTemperatureChannel_ + coreCount() + i))) {
+			request(IA32_THERM_STATUS_MSR, affinity, Target::CoreTemperature, i);
+		}
+		// the bus clock is reported only if a core clock was read, the first sampled core provides it
+		if (clocksSampled && i < coreClocks_.size() &&
+		    (sampled.test(SensorType::frequency, busClockChannel_ + 1 + i) ||
+		     (busClockSampled && !busClockRequested))) {
+			request(IA32_PERF_STATUS, affinity, Target::CoreClock, i);
+			busClockRequested = true;
+		}
+	}
 
-		if (Ring0::instance().readMSR(IA32_THERM_STATUS_MSR, eax, edx, cpuIdData()[i][0].affinity()) &&
-		    (eax & 0x80000000) != 0) {
-			// get the dist from tjMax from bits 22:16
-			double deltaT = static_cast<float>((eax & 0x007F0000) >> 16);
-			coreTemperatures_[i].value = coreTemperatures_[i].tjMax - coreTemperatures_[i].slope * deltaT;
+	if (packageTemperature_.has_value() && sampled.test(SensorType::temp, packageTemperatureChannel_)) {
+		request(IA32_PACKAGE_THERM_STATUS, cpu0IdData().affinity(), Target::PackageTemperature, 0);
+	}
 
-			coreAvg += coreTemperatures_[i].value;
-			if (coreMax < coreTemperatures_[i].value) {
-				coreMax = coreTemperatures_[i].value;
-			}
-		} else {
-			coreTemperatures_[i].value = std::numeric_limits<decltype(CoreTempData::value)>::quiet_NaN();
+	// energy counters are package-wide, reading them on the first core joins the package temperature read
+	for (std::size_t i = 0; i < powerSensors_.size(); ++i) {
+		if (!std::isnan(powerSensors_[i]) && sampled.test(SensorType::power, powerChannels_[i])) {
+			request(energyStatusMsrs[i], cpu0IdData().affinity(), Target::Energy, i);
 		}
 	}
 
-	// calculate average cpu temperature over all cores
-	if (coreMaxTemperature_.has_value() &&
-	    coreMax > std::numeric_limits<decltype(coreMaxTemperature_)::value_type>::min()) {
-		coreMaxTemperature_= coreMax;
-		coreAvg /= static_cast<double>(coreTemperatures_.size());
-		coreAvgTemperature_ = coreAvg;
+	if (batch.empty()) {
+		return;
 	}
 
-	if (packageTemperature_.has_value()) {
-		// if reading is valid
-		u32 eax, edx;
-		if (Ring0::instance().readMSR(IA32_PACKAGE_THERM_STATUS, eax, edx, cpu0IdData().affinity()) &&
-		    (eax & 0x80000000) != 0) {
-			// get the dist from tjMax from bits 22:16
-			double deltaT = static_cast<double>((eax & 0x007F0000) >> 16);
-			packageTemperature_.value().update(deltaT);
-		} else {
-			packageTemperature_.reset();
+	{
+		ReadTimer timer{*this, "msr"};
+		Ring0::instance().readMSRs(batch);
+	}
+	const auto readTime = std::chrono::steady_clock::now();
+
+	bool busClockRead = false;
+	for (std::size_t j = 0; j < batch.size(); ++j) {
+		const Ring0::MSRRead& r = batch[j];
+		const std::size_t i = targets[j].second;
+		switch (targets[j].first) {
+			case Target::CoreTemperature: decodeCoreTemperature(i, r); break;
+			case Target::CoreClock: busClockRead = decodeCoreClock(i, r, busClock) || busClockRead; break;
+			case Target::PackageTemperature:
+				// if reading is valid
+				if (r.succeeded && (r.value.reg.eax & 0x80000000) != 0) {
+					// get the dist from tjMax from bits 22:16
+					double deltaT = static_cast<double>((r.value.reg.eax & 0x007F0000) >> 16);
+					packageTemperature_->update(deltaT);
+				} else {
+					packageTemperature_->value = std::numeric_limits<double>::quiet_NaN();
+				}
+				break;
+			case Target::Energy: {
+				if (!r.succeeded) {
+					break;
+				}
+				u32   energyConsumed = r.value.reg.eax;
+				const auto elapsed = readTime - lastEnergyTime_[i];
+				float deltaTime =
+				    static_cast<float>(std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count()) * 1e-6f;
+				if (deltaTime < 0.01) {
+					break;
+				}
+
+				powerSensors_[i] =
+				    energyUnitMultiplier_ * static_cast<double>(energyConsumed - lastEnergyConsumed_[i]) / deltaTime;
+				lastEnergyTime_[i] = readTime;
+				lastEnergyConsumed_[i] = energyConsumed;
+			} break;
 		}
 	}
 
-	if (hasTimeStampCounter() && timeStampCounterMultiplier_ > 0) {
-		double newBusClock = 0;
-		for (std::size_t i = 0; i < coreClocks_.size(); i++) {
-			std::this_thread::sleep_for(std::chrono::milliseconds(1));
-			u32 eax, edx;
-			if (Ring0::instance().readMSR(IA32_PERF_STATUS, eax, edx, cpu0IdData().affinity())) {
-				newBusClock = timeStampCounterFrequency() / timeStampCounterMultiplier_;
-				switch (microArchitecture_) {
-					case MicroArchitecture::Nehalem: {
-						u32 multiplier = eax & 0xff;
-						coreClocks_[i] = multiplier * newBusClock;
-						break;
-					}
-					case MicroArchitecture::Airmont:
-					case MicroArchitecture::AlderLake:
-					case MicroArchitecture::Broadwell:
-					case MicroArchitecture::CannonLake:
-					case MicroArchitecture::CometLake:
-					case MicroArchitecture::Goldmont:
-					case MicroArchitecture::GoldmontPlus:
-					case MicroArchitecture::Haswell:
-					case MicroArchitecture::IceLake:
-					case MicroArchitecture::IvyBridge:
-					case MicroArchitecture::JasperLake:
-					case MicroArchitecture::KabyLake:
-					case MicroArchitecture::RocketLake:
-					case MicroArchitecture::SandyBridge:
-					case MicroArchitecture::Silvermont:
-					case MicroArchitecture::Skylake:
-					case MicroArchitecture::TigerLake:
-					case MicroArchitecture::Tremont: {
-						u32 multiplier = (eax >> 8) & 0xff;
-						coreClocks_[i] = multiplier * newBusClock;
-						break;
-					}
-					default: {
-						double multiplier = ((eax >> 8) & 0x1f) + 0.5 * ((eax >> 14) & 1);
-						coreClocks_[i] = multiplier * newBusClock;
-						break;
-					}
-				}
-			} else {
-				// if IA32_PERF_STATUS is not available, assume TSC frequency
-				coreClocks_[i] = timeStampCounterFrequency();
+	// calculate average cpu temperature over all cores
+	if (coreAggregatesSampled) {
+		double coreMax = std::numeric_limits<double>::lowest();
+		double coreSum = 0.;
+		bool valid = false;
+		for (const auto& t: coreTemperatures_) {
+			if (!std::isnan(t.value)) {
+				coreSum += t.value;
+				coreMax = std::max(coreMax, t.value);
+				valid = true;
 			}
 		}
-
-		if (newBusClock > 0) {
-			busClock_ = newBusClock; // TODO activate
+		if (valid) {
+			coreMaxTemperature_ = coreMax;
+			coreAvgTemperature_ = coreSum / static_cast<double>(coreTemperatures_.size());
 		}
 	}
 
-	for (std::size_t i = 0; i < powerSensors_.size(); ++i) {
-		if (std::isnan(powerSensors_[i])) {
-			continue;
-		}
+	if (busClockRead) {
+		busClock_ = busClock;
+	}
+}
 
-		u32 eax, edx;
-		if (!Ring0::instance().readMSR(energyStatusMsrs[i], eax, edx)) {
-			continue;
-		}
+wm_sensors::SensorChip::ChannelCost
+wm_sensors::hardware::cpu::IntelCPU::readCost(SensorType type, std::size_t channel) const
+{
+	// MSR reads, all of them are done in a single batch
+	switch (type) {
+		case SensorType::temp:
+		case SensorType::power: return {ReadCost::Register, "msr"};
+		case SensorType::frequency:
+			if (busClock_.has_value() && channel >= busClockChannel_ &&
+			    channel <= busClockChannel_ + coreClocks_.size()) {
+				return {ReadCost::Register, "msr"};
+			}
+			break;
+		default: break;
+	}
+	return base::readCost(type, channel);
+}
 
+void wm_sensors::hardware::cpu::IntelCPU::decodeCoreTemperature(std::size_t i, const Ring0::MSRRead& r) const
+{
+	// if reading is valid
+	if (r.succeeded && (r.value.reg.eax & 0x80000000) != 0) {
+		// get the dist from tjMax from bits 22:16
+		double deltaT = static_cast<float>((r.value.reg.eax & 0x007F0000) >> 16);
+		coreTemperatures_[i].update(deltaT);
+	} else {
+		coreTemperatures_[i].value = std::numeric_limits<decltype(CoreTempData::value)>::quiet_NaN();
+		coreTemperatures_[i].deltaT = std::numeric_limits<decltype(CoreTempData::deltaT)>::quiet_NaN();
+	}
+}
 
-		auto  time = std::chrono::steady_clock::now();
-		u32   energyConsumed = eax;
-		float deltaTime =
-		    static_cast<float>(std::chrono::duration_cast<std::chrono::microseconds>(time - lastEnergyTime_[i]).count()) * 1e-6f;
-		if (deltaTime < 0.01) {
-			continue;
-		}
+bool wm_sensors::hardware::cpu::IntelCPU::decodeCoreClock(std::size_t i, const Ring0::MSRRead& r, double busClock) const
+{
+	if (!r.succeeded) {
+		// if IA32_PERF_STATUS is not available, assume TSC frequency
+		coreClocks_[i] = timeStampCounterFrequency();
+		return false;
+	}
 
+	const u32 eax = r.value.reg.eax;
 
-		powerSensors_[i] = energyUnitMultiplier_ * static_cast<float>(energyConsumed - lastEnergyConsumed_[i]) / deltaTime;
-		lastEnergyTime_[i] = time;
-		lastEnergyConsumed_[i] = energyConsumed;
+	switch (microArchitecture_) {
+		case MicroArchitecture::Nehalem: {
+			u32 multiplier = eax & 0xff;
+			coreClocks_[i] = multiplier * busClock;
+			break;
+		}
+		case MicroArchitecture::Airmont:
+		case MicroArchitecture::AlderLake:
+		case MicroArchitecture::Broadwell:
+		case MicroArchitecture::CannonLake:
+		case MicroArchitecture::CometLake:
+		case MicroArchitecture::Goldmont:
+		case MicroArchitecture::GoldmontPlus:
+		case MicroArchitecture::Haswell:
+		case MicroArchitecture::IceLake:
+		case MicroArchitecture::IvyBridge:
+		case MicroArchitecture::JasperLake:
+		case MicroArchitecture::KabyLake:
+		case MicroArchitecture::RocketLake:
+		case MicroArchitecture::SandyBridge:
+		case MicroArchitecture::Silvermont:
+		case MicroArchitecture::Skylake:
+		case MicroArchitecture::TigerLake:
+		case MicroArchitecture::Tremont: {
+			u32 multiplier = (eax >> 8) & 0xff;
+			coreClocks_[i] = multiplier * busClock;
+			break;
+		}
+		default: {
+			double multiplier = ((eax >> 8) & 0x1f) + 0.5 * ((eax >> 14) & 1);
+			coreClocks_[i] = multiplier * busClock;
+			break;
+		}
 	}
+	return true;
 }
 
-std::vector<float> wm_sensors::hardware::cpu::IntelCPU::tjsFromMSR()
+std::vector<float> wm_sensors::hardware::cpu::IntelCPU::tjsFromMSR() const
 {
 	std::vector<float> result(coreCount());
 	for (std::size_t i = 0; i < result.size(); i++) {
@@ -4,6 +4,7 @@
 #define WM_SENSORS_LIB_HARDWARE_CPU_INTEL_CPU_HXX
 
 #include "../generic_cpu.hxx"
+#include "../../impl/ring0.hxx"
 
 #include <chrono>
 #include <optional>
@@ -15,9 +16,7 @@ namespace wm_sensors::hardware::cpu {
 	public:
 		IntelCPU(unsigned processorIndex, std::vector<std::vector<CPUIDData>>&& cpuId);
 
-		Config config() const override;
-		int read(SensorType type, u32 attr, std::size_t channel, double& val) const override;
-		int read(SensorType type, u32 attr, std::size_t channel, std::string_view& str) const override;
+		ChannelCost readCost(SensorType type, std::size_t channel) const override;
 
 #if 0
 		override string GetReport()
@@ -61,15 +60,14 @@ namespace wm_sensors::hardware::cpu {
 			Unknown
 		};
 
-		void update() const;
+		void initialize() const override;
+		void refreshSensors() const override;
 
-		Config::ChannelCounts baseChannels_;
-
-		std::vector<float> tjsFromMSR();
-
-		std::vector<std::string> temperatureLabels_;
-		std::vector<std::string> frequencyLabels_;
-		std::vector<std::string> powerLabels_;
+		std::vector<float> tjsFromMSR() const;
+		/** Decodes IA32_THERM_STATUS of the core */
+		void decodeCoreTemperature(std::size_t core, const impl::Ring0::MSRRead& thermStatus) const;
+		/** Decodes IA32_PERF_STATUS of the core, returns false if the register is not available */
+		bool decodeCoreClock(std::size_t core, const impl::Ring0::MSRRead& perfStatus, double busClock) const;
 
 		mutable std::optional<double> busClock_;
 		mutable std::vector<double> coreClocks_;
@@ -90,9 +88,16 @@ namespace wm_sensors::hardware::cpu {
 		mutable std::vector<std::chrono::steady_clock::time_point> lastEnergyTime_;
 		mutable MicroArchitecture microArchitecture_;
 		mutable std::optional<CoreTempData> packageTemperature_;
-		mutable std::vector<float> powerSensors_;
-		double timeStampCounterMultiplier_;
-		mutable std::chrono::steady_clock::time_point lastUpdate_;
+		mutable std::vector<double> powerSensors_;
+		bool tjMaxFromMsr_; // tjMax values are read by initialize()
+		mutable double timeStampCounterMultiplier_;
+
+		// channel indices, refresh skips MSR reads behind disabled channels
+		std::size_t coreTemperatureChannel_; // followed by distances to TjMax
+		std::size_t packageTemperatureChannel_;
+		std::size_t coreMaxTemperatureChannel_; // followed by the average
+		std::size_t busClockChannel_;           // followed by core clocks
+		std::vector<std::size_t> powerChannels_;
 
 		DELETE_COPY_CTOR_AND_ASSIGNMENT(IntelCPU)
 	};
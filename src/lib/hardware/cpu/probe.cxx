@@ -15,6 +15,7 @@
 #	define _AMD64_
 #endif
 #include <cmath>
+#include <future>
 #include <map>
 #include <stdexcept>
 #include <sysinfoapi.h>
@@ -102,6 +103,8 @@ bool wm_sensors::hardware::cpu::CPUProbe::probe(SensorChipTreeNode& sensorsTree)
 
 	//_threads = new CpuId[processorThreads.Length][][];
 
+	// packages are constructed concurrently, each one queries MSRs and PCI devices to build its channels
+	std::vector<std::future<std::unique_ptr<SensorChip>>> packages;
 	unsigned index = 0;
 	for (auto& threads: procThreads) {
 		if (threads.empty())
@@ -112,10 +115,10 @@ bool wm_sensors::hardware::cpu::CPUProbe::probe(SensorChipTreeNode& sensorsTree)
 		std::vector<std::vector<CPUIDData>> coreThreads = groupThreadsByCore(std::move(threads));
 		//_threads[index] = coreThreads;
 
-		SensorChipTreeNode& cpuNode = sensorsTree.child("cpu");
-
 		auto addCpuPayload = [&]<typename T>(unsigned index) {
-			cpuNode.addPayload(std::unique_ptr<SensorChip>(new T(index, std::move(coreThreads))));
+			packages.push_back(std::async(std::launch::async, [index, ct = std::move(coreThreads)]() mutable {
+				return std::unique_ptr<SensorChip>(new T(index, std::move(ct)));
+			}));
 		};
 
 		switch (vendor) {
@@ -152,5 +155,15 @@ bool wm_sensors::hardware::cpu::CPUProbe::probe(SensorChipTreeNode& sensorsTree)
 
 		index++;
 	}
+
+	for (auto& p: packages) {
+		p.wait();
+	}
+	if (!packages.empty()) {
+		SensorChipTreeNode& cpuNode = sensorsTree.child("cpu");
+		for (auto& p: packages) {
+			cpuNode.addPayload(p.get());
+		}
+	}
 	return true;
 }
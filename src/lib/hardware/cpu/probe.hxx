@@ -9,6 +9,10 @@ namespace wm_sensors::hardware::cpu {
 	class CPUProbe: public wm_sensors::impl::ChipProbe {
 		// Inherited via ChipProbe
 		virtual bool probe(SensorChipTreeNode& sensorsTree) override;
+		std::string_view name() const override
+		{
+			return "cpu";
+		}
 	};
 }
 
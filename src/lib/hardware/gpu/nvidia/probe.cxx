@@ -11,6 +11,14 @@ namespace wm_sensors::hardware::gpu {
 	class NVIDIAGPUProbe: public wm_sensors::impl::ChipProbe {
 		// Inherited via ChipProbe
 		virtual bool probe(SensorChipTreeNode& sensorsTree) override;
+		std::string_view name() const override
+		{
+			return "nvidia-gpu";
+		}
+		bool deferrable() const override
+		{
+			return true;
+		}
 	};
 
 	bool NVIDIAGPUProbe::probe(SensorChipTreeNode& /*sensorsTree*/)
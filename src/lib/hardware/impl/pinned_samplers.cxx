@@ -0,0 +1,167 @@
+// SPDX-License-Identifier: LGPL-3.0+
+
+#include "./pinned_samplers.hxx"
+
+#include <spdlog/spdlog.h>
+
+#include <exception>
+#include <thread>
+
+namespace {
+	using wm_sensors::impl::GroupAffinity;
+
+	// the pool is owned by its users, the static keeps a weak reference only
+	std::mutex poolMutex;
+	std::weak_ptr<wm_sensors::hardware::impl::PinnedSamplers> pool;
+	// nested register accesses of a task are done by the worker itself
+	thread_local bool onWorker = false;
+
+	void runTask(const std::function<void()>& task)
+	{
+		try {
+			task();
+		} catch (const std::exception& e) {
+			spdlog::error("Pinned sampler task failed: {}", e.what());
+		}
+	}
+} // namespace
+
+struct wm_sensors::hardware::impl::PinnedSamplers::Worker {
+	Worker(GroupAffinity a, std::atomic<std::size_t>& pending);
+	~Worker();
+
+	DELETE_COPY_CTOR_AND_ASSIGNMENT(Worker)
+
+	void post(const std::function<void()>& task);
+	void loop();
+
+	GroupAffinity affinity;
+	std::atomic<std::size_t>& pending;
+	std::atomic<const std::function<void()>*> task; // posted by run(), cleared by the worker when done
+	std::atomic<bool> shutdown;
+	std::thread thread;
+};
+
+wm_sensors::hardware::impl::PinnedSamplers::Worker::Worker(GroupAffinity a, std::atomic<std::size_t>& p)
+    : affinity{a}
+    , pending{p}
+    , task{nullptr}
+    , shutdown{false}
+{
+	thread = std::thread([this] { loop(); });
+}
+
+wm_sensors::hardware::impl::PinnedSamplers::Worker::~Worker()
+{
+	static const std::function<void()> wakeUp;
+	shutdown.store(true, std::memory_order_relaxed);
+	task.store(&wakeUp, std::memory_order_release);
+	task.notify_one();
+	thread.join();
+}
+
+void wm_sensors::hardware::impl::PinnedSamplers::Worker::post(const std::function<void()>& t)
+{
+	task.store(&t, std::memory_order_release);
+	task.notify_one();
+}
+
+void wm_sensors::hardware::impl::PinnedSamplers::Worker::loop()
+{
+	onWorker = true;
+	GroupAffinity::set(affinity);
+	for (;;) {
+		task.wait(nullptr, std::memory_order_acquire);
+		if (shutdown.load(std::memory_order_relaxed)) {
+			return;
+		}
+		runTask(*task.load(std::memory_order_acquire));
+		task.store(nullptr, std::memory_order_relaxed);
+		if (pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+			pending.notify_one();
+		}
+	}
+}
+
+wm_sensors::hardware::impl::PinnedSamplers::PinnedSamplers()
+    : pending_{0}
+{
+}
+
+wm_sensors::hardware::impl::PinnedSamplers::~PinnedSamplers() = default;
+
+std::shared_ptr<wm_sensors::hardware::impl::PinnedSamplers> wm_sensors::hardware::impl::PinnedSamplers::acquire()
+{
+	std::lock_guard<std::mutex> lock{poolMutex};
+	auto res = pool.lock();
+	if (!res) {
+		res.reset(new PinnedSamplers());
+		pool = res;
+	}
+	return res;
+}
+
+std::shared_ptr<wm_sensors::hardware::impl::PinnedSamplers> wm_sensors::hardware::impl::PinnedSamplers::active()
+{
+	if (onWorker) {
+		return nullptr;
+	}
+	std::lock_guard<std::mutex> lock{poolMutex};
+	return pool.lock();
+}
+
+void wm_sensors::hardware::impl::PinnedSamplers::runOn(const GroupAffinity& affinity, const std::function<void()>& fn)
+{
+	if (const auto samplers = active()) {
+		samplers->run(affinity, fn);
+	} else {
+		wm_sensors::impl::ThreadGroupAffinityGuard guard{affinity};
+		fn();
+	}
+}
+
+wm_sensors::hardware::impl::PinnedSamplers::Worker&
+wm_sensors::hardware::impl::PinnedSamplers::worker(const GroupAffinity& affinity)
+{
+	for (const auto& w: workers_) {
+		if (w->affinity == affinity) {
+			return *w;
+		}
+	}
+	workers_.push_back(std::make_unique<Worker>(affinity, pending_));
+	return *workers_.back();
+}
+
+void wm_sensors::hardware::impl::PinnedSamplers::run(std::span<const Task> tasks)
+{
+	// tasks for the caller run before the lock is taken, so that they may post tasks of their own
+	std::size_t posted = 0;
+	for (const Task& t: tasks) {
+		if (t.affinity == GroupAffinity::undefined()) {
+			runTask(t.run);
+		} else {
+			++posted;
+		}
+	}
+	if (posted == 0) {
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock{mutex_};
+	pending_.store(posted, std::memory_order_relaxed);
+	for (const Task& t: tasks) {
+		if (!(t.affinity == GroupAffinity::undefined())) {
+			worker(t.affinity).post(t.run);
+		}
+	}
+
+	for (std::size_t p; (p = pending_.load(std::memory_order_acquire)) != 0;) {
+		pending_.wait(p, std::memory_order_acquire);
+	}
+}
+
+void wm_sensors::hardware::impl::PinnedSamplers::run(const GroupAffinity& affinity, std::function<void()> fn)
+{
+	const Task task{affinity, std::move(fn)};
+	run(std::span<const Task>{&task, 1});
+}
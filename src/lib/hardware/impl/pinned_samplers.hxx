@@ -0,0 +1,74 @@
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef WM_SENSORS_LIB_HARDWARE_IMPL_PINNED_SAMPLERS_HXX
+#define WM_SENSORS_LIB_HARDWARE_IMPL_PINNED_SAMPLERS_HXX
+
+#include "../../impl/group_affinity.hxx"
+#include "../../utility/macro.hxx"
+
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <vector>
+
+namespace wm_sensors::hardware::impl {
+	/**
+	 * @brief Worker threads, each one pinned to a single affinity for its lifetime
+	 *
+	 * Per-CPU register accesses are posted to the worker pinned to the target CPU instead of moving the calling
+	 * thread there. The caller keeps its caches and scheduling, and the CPUs are sampled in parallel, each by a thread
+	 * local to its NUMA node. A worker starts on the first request for its affinity. The CPU chips request the first
+	 * thread of each core, so there is one worker per core.
+	 *
+	 * Tasks are handed over through an atomic slot per worker and completion is awaited on an atomic counter, the
+	 * mutex only serializes concurrent run() calls. The pool is process-wide, it runs while an owner obtained from
+	 * acquire() exists (see SensorsTree::Options::pinnedSamplers) and its workers are joined when the last owner
+	 * releases it, never from a static destructor.
+	 */
+	class PinnedSamplers {
+	public:
+		struct Task {
+			wm_sensors::impl::GroupAffinity affinity;
+			std::function<void()> run;
+		};
+
+		~PinnedSamplers();
+
+		/** Starts the pool or shares the running one */
+		static std::shared_ptr<PinnedSamplers> acquire();
+		/**
+		 * The running pool, nullptr if there is none or when called from a worker, register accesses are then done
+		 * by the calling thread
+		 */
+		static std::shared_ptr<PinnedSamplers> active();
+
+		/**
+		 * Runs @p fn on the CPU of @p affinity: on the worker pinned to it while the pool runs, otherwise on the
+		 * calling thread moved there for the call
+		 */
+		static void runOn(const wm_sensors::impl::GroupAffinity& affinity, const std::function<void()>& fn);
+
+		/**
+		 * Runs the tasks in parallel, each one on the worker pinned to its affinity, and returns when all of them
+		 * complete. Affinities of the tasks have to be distinct, tasks with undefined affinity run on the caller.
+		 */
+		void run(std::span<const Task> tasks);
+		/** Runs @p fn on the worker pinned to @p affinity and waits for it */
+		void run(const wm_sensors::impl::GroupAffinity& affinity, std::function<void()> fn);
+
+	private:
+		PinnedSamplers();
+		DELETE_COPY_CTOR_AND_ASSIGNMENT(PinnedSamplers)
+
+		struct Worker;
+		Worker& worker(const wm_sensors::impl::GroupAffinity& affinity);
+
+		std::vector<std::unique_ptr<Worker>> workers_;
+		std::atomic<std::size_t> pending_; // tasks of the current run() not completed yet
+		std::mutex mutex_;                 // held by run(), guards workers_
+	};
+} // namespace wm_sensors::hardware::impl
+
+#endif
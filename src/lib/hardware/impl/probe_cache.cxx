@@ -0,0 +1,160 @@
+// SPDX-License-Identifier: LGPL-3.0+
+
+#include "./probe_cache.hxx"
+
+#include "../cpu/cpuid.hxx"
+#include "../smbios.hxx"
+
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+#include <cstdlib>
+#include <fstream>
+#include <system_error>
+
+namespace {
+	// bump when the format of any entry changes
+	constexpr const std::string_view header = "wm-sensors probe cache 1";
+
+	wm_sensors::u64 fnv1a(std::string_view s)
+	{
+		wm_sensors::u64 res = 0xcbf29ce484222325ull;
+		for (char c: s) {
+			res = (res ^ static_cast<unsigned char>(c)) * 0x100000001b3ull;
+		}
+		return res;
+	}
+
+	std::filesystem::path cachePath()
+	{
+		if (const char* path = std::getenv("WM_SENSORS_PROBE_CACHE")) {
+			return path;
+		}
+		if (const char* appData = std::getenv("LOCALAPPDATA")) {
+			return std::filesystem::path(appData) / "wm-sensors" / "probe-cache.txt";
+		}
+		return {};
+	}
+} // namespace
+
+wm_sensors::hardware::impl::ProbeCache::ProbeCache()
+    : path_{cachePath()}
+{
+	if (path_.empty()) {
+		return;
+	}
+	try {
+		fingerprint_ = fingerprint();
+	} catch (const std::exception& e) {
+		spdlog::warn("Could not identify the machine, probe cache is disabled: {}", e.what());
+		path_.clear();
+		return;
+	}
+	load();
+}
+
+wm_sensors::hardware::impl::ProbeCache& wm_sensors::hardware::impl::ProbeCache::instance()
+{
+	static ProbeCache instance;
+	return instance;
+}
+
+std::string wm_sensors::hardware::impl::ProbeCache::fingerprint()
+{
+	std::string id;
+	const SMBios smbios;
+	if (smbios.board()) {
+		id += fmt::format("{}\n{}\n{}\n", smbios.board()->manufacturerName(), smbios.board()->productName(),
+		    smbios.board()->version());
+	}
+	if (smbios.bios()) {
+		id += fmt::format("{}\n{}\n", smbios.bios()->vendor(), smbios.bios()->version());
+	}
+	const auto cpu = cpu::CPUIDData::get(0, 0);
+	id += fmt::format("{}\n{}\n{:x}\n", cpu.name(), cpu.brand(), cpu.data().size() > 1 ? cpu.data()[1][0] : 0u);
+	return fmt::format("{:016x}", fnv1a(id));
+}
+
+std::optional<std::string> wm_sensors::hardware::impl::ProbeCache::get(std::string_view key) const
+{
+	std::lock_guard<std::mutex> lock{mutex_};
+	const auto it = entries_.find(key);
+	if (it == entries_.end()) {
+		return {};
+	}
+	return it->second;
+}
+
+void wm_sensors::hardware::impl::ProbeCache::set(std::string_view key, std::string value)
+{
+	std::lock_guard<std::mutex> lock{mutex_};
+	const auto it = entries_.find(key);
+	if (it != entries_.end()) {
+		if (it->second == value) {
+			return;
+		}
+		it->second = std::move(value);
+	} else {
+		entries_.emplace(std::string(key), std::move(value));
+	}
+	save();
+}
+
+void wm_sensors::hardware::impl::ProbeCache::remove(std::string_view key)
+{
+	std::lock_guard<std::mutex> lock{mutex_};
+	const auto it = entries_.find(key);
+	if (it == entries_.end()) {
+		return;
+	}
+	entries_.erase(it);
+	save();
+}
+
+void wm_sensors::hardware::impl::ProbeCache::load()
+{
+	std::ifstream f{path_};
+	if (!f) {
+		return;
+	}
+
+	std::string line;
+	if (!std::getline(f, line) || line != header || !std::getline(f, line) || line != fingerprint_) {
+		spdlog::info("Probe cache '{}' is outdated, hardware will be detected anew", path_.string());
+		return;
+	}
+	while (std::getline(f, line)) {
+		const auto space = line.find(' ');
+		if (space != std::string::npos) {
+			entries_.emplace(line.substr(0, space), line.substr(space + 1));
+		}
+	}
+}
+
+void wm_sensors::hardware::impl::ProbeCache::save() const
+{
+	if (path_.empty()) {
+		return;
+	}
+
+	std::error_code ec;
+	std::filesystem::create_directories(path_.parent_path(), ec);
+	// write a new file and replace the old one, so that readers never see a partial file
+	auto tmpPath = path_;
+	tmpPath += ".tmp";
+	{
+		std::ofstream f{tmpPath, std::ios::trunc};
+		f << header << '\n' << fingerprint_ << '\n';
+		for (const auto& [key, value]: entries_) {
+			f << key << ' ' << value << '\n';
+		}
+		if (!f) {
+			spdlog::warn("Could not write probe cache '{}'", tmpPath.string());
+			return;
+		}
+	}
+	std::filesystem::rename(tmpPath, path_, ec);
+	if (ec) {
+		spdlog::warn("Could not write probe cache '{}': {}", path_.string(), ec.message());
+	}
+}
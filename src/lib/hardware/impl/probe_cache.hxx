@@ -0,0 +1,52 @@
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef WM_SENSORS_LIB_HARDWARE_IMPL_PROBE_CACHE_HXX
+#define WM_SENSORS_LIB_HARDWARE_IMPL_PROBE_CACHE_HXX
+
+#include "../../utility/macro.hxx"
+
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+
+namespace wm_sensors::hardware::impl {
+	/**
+	 * @brief Hardware detection results persisted between runs
+	 *
+	 * Entries are stored in a file together with a fingerprint of the machine, built from SMBIOS board and BIOS
+	 * strings and CPUID. The entries are discarded when the fingerprint does not match. Cached values are hints only:
+	 * users validate them with a cheap hardware access and fall back to full detection if validation fails.
+	 *
+	 * The file is "%LOCALAPPDATA%\wm-sensors\probe-cache.txt", the WM_SENSORS_PROBE_CACHE environment variable
+	 * overrides the path, setting it to an empty string disables the cache.
+	 */
+	class ProbeCache {
+	public:
+		static ProbeCache& instance();
+
+		std::optional<std::string> get(std::string_view key) const;
+		/** Stores the value and writes the file if the value changed */
+		void set(std::string_view key, std::string value);
+		/** Drops the entry and writes the file if there was one */
+		void remove(std::string_view key);
+
+	private:
+		ProbeCache();
+		DELETE_COPY_CTOR_AND_ASSIGNMENT(ProbeCache)
+
+		static std::string fingerprint();
+		void load();
+		void save() const;
+
+		std::filesystem::path path_;
+		std::string fingerprint_;
+		std::map<std::string, std::string, std::less<>> entries_;
+		mutable std::mutex mutex_;
+	};
+} // namespace wm_sensors::hardware::impl
+
+#endif
@@ -2,16 +2,20 @@
 
 #include "./ring0.hxx"
 
+#include "./pinned_samplers.hxx"
 #include "./ring0/inpout.hxx"
 #include "./ring0/winring0.hxx"
 #include "../../impl/group_affinity.hxx"
 
 #include <Windows.h>
 
+#include <algorithm>
 #include <map>
 #include <memory>
+#include <numeric>
 #include <string>
 #include <string_view>
+#include <vector>
 
 namespace {
 	using wm_sensors::hardware::impl::GlobalMutex;
@@ -104,14 +108,65 @@ bool wm_sensors::hardware::impl::Ring0::readMSR(u32 index, MSRValue& value)
 bool wm_sensors::hardware::impl::Ring0::readMSR(
     u32 index, u32& eax, u32& edx, const wm_sensors::impl::GroupAffinity& affinity)
 {
-	wm_sensors::impl::ThreadGroupAffinityGuard g{affinity};
-	return readMSR(index, eax, edx);
+	bool res = false;
+	PinnedSamplers::runOn(affinity, [&] { res = readMSR(index, eax, edx); });
+	return res;
 }
 
 bool wm_sensors::hardware::impl::Ring0::readMSR(u32 index, MSRValue& value, const wm_sensors::impl::GroupAffinity& affinity)
 {
-	wm_sensors::impl::ThreadGroupAffinityGuard g{affinity};
-	return readMSR(index, value);
+	return readMSR(index, value.reg.eax, value.reg.edx, affinity);
+}
+
+bool wm_sensors::hardware::impl::Ring0::readMSRs(std::span<MSRRead> batch)
+{
+	using wm_sensors::impl::GroupAffinity;
+
+	std::vector<std::size_t> order(batch.size());
+	std::iota(order.begin(), order.end(), std::size_t{0});
+	std::stable_sort(order.begin(), order.end(), [&batch](std::size_t a, std::size_t b) {
+		const GroupAffinity& l = batch[a].affinity;
+		const GroupAffinity& r = batch[b].affinity;
+		return l.group() < r.group() || (l.group() == r.group() && l.mask() < r.mask());
+	});
+
+	if (const auto samplers = PinnedSamplers::active()) {
+		// a task per affinity, the pinned workers read their registers in parallel
+		std::vector<PinnedSamplers::Task> tasks;
+		for (std::size_t first = 0; first < order.size();) {
+			std::size_t last = first + 1;
+			while (last < order.size() && batch[order[last]].affinity == batch[order[first]].affinity) {
+				++last;
+			}
+			const auto readRange = [this, &batch, &order, first, last] {
+				for (std::size_t i = first; i < last; ++i) {
+					MSRRead& r = batch[order[i]];
+					r.succeeded = readMSR(r.index, r.value);
+				}
+			};
+			tasks.push_back({batch[order[first]].affinity, readRange});
+			first = last;
+		}
+		samplers->run(tasks);
+		return std::all_of(batch.begin(), batch.end(), [](const MSRRead& r) { return r.succeeded; });
+	}
+
+	const GroupAffinity original = GroupAffinity::current();
+	GroupAffinity current = original;
+	bool res = true;
+	for (std::size_t i: order) {
+		MSRRead& r = batch[i];
+		if (!(r.affinity == current)) {
+			GroupAffinity::set(r.affinity);
+			current = r.affinity;
+		}
+		r.succeeded = readMSR(r.index, r.value);
+		res = res && r.succeeded;
+	}
+	if (!(current == original)) {
+		GroupAffinity::set(original);
+	}
+	return res;
 }
 
 bool wm_sensors::hardware::impl::Ring0::writeMSR(u32 index, u32 eax, u32 edx)
@@ -127,15 +182,15 @@ bool wm_sensors::hardware::impl::Ring0::writeMSR(u32 index, MSRValue value)
 bool wm_sensors::hardware::impl::Ring0::writeMSR(
     u32 index, u32 eax, u32 edx, const wm_sensors::impl::GroupAffinity& affinity)
 {
-	wm_sensors::impl::ThreadGroupAffinityGuard g{affinity};
-	return writeMSR(index, eax, edx);
+	bool res = false;
+	PinnedSamplers::runOn(affinity, [&] { res = writeMSR(index, eax, edx); });
+	return res;
 }
 
 bool wm_sensors::hardware::impl::Ring0::writeMSR(
     u32 index, MSRValue value, const wm_sensors::impl::GroupAffinity& affinity)
 {
-	wm_sensors::impl::ThreadGroupAffinityGuard g{affinity};
-	return writeMSR(index, value);
+	return writeMSR(index, value.reg.eax, value.reg.edx, affinity);
 }
 
 wm_sensors::u8 wm_sensors::hardware::impl::Ring0::readIOPort(u16 port)
@@ -3,17 +3,15 @@
 #ifndef WM_SENSORS_LIB_HARDWARE_IMPL_RING0_HXX
 #define WM_SENSORS_LIB_HARDWARE_IMPL_RING0_HXX
 
+#include "../../impl/group_affinity.hxx"
 #include "../../wm_sensor_types.hxx"
 
 #include <chrono>
 #include <memory>
+#include <span>
 #include <stdexcept>
 #include <string>
 
-namespace wm_sensors::impl {
-	class GroupAffinity;
-}
-
 namespace wm_sensors::hardware::impl {
 
 	enum class GlobalMutex
@@ -24,6 +22,12 @@ namespace wm_sensors::hardware::impl {
 		SMBus
 	};
 
+	/** Bit of the mutex in SensorChip::RefreshDomain::systemLocks */
+	constexpr u32 systemLockBit(GlobalMutex mutex)
+	{
+		return u32{1} << static_cast<unsigned>(mutex);
+	}
+
 	class Ring0 {
 	public:
 		static Ring0& instance();
@@ -43,6 +47,23 @@ namespace wm_sensors::hardware::impl {
 		bool readMSR(u32 index, MSRValue& value);
 		bool readMSR(u32 index, u32& eax, u32& edx, const wm_sensors::impl::GroupAffinity& affinity);
 		bool readMSR(u32 index, MSRValue& value, const wm_sensors::impl::GroupAffinity& affinity);
+
+		/** Request of readMSRs(), the result is stored in the request */
+		struct MSRRead {
+			u32 index;
+			wm_sensors::impl::GroupAffinity affinity; // CPU to read on
+			MSRValue value;
+			bool succeeded;
+		};
+
+		/**
+		 * Reads a batch of MSRs grouped by their affinity, so that the thread moves to each CPU once and stays
+		 * where it is for requests targeting its current affinity. With PinnedSamplers enabled the groups are read in
+		 * parallel by the pinned workers instead, as are the single reads and writes with an affinity. Returns true
+		 * if all reads succeeded.
+		 */
+		bool readMSRs(std::span<MSRRead> batch);
+
 		bool writeMSR(u32 index, u32 eax, u32 edx);
 		bool writeMSR(u32 index, MSRValue value);
 		bool writeMSR(u32 index, u32 eax, u32 edx, const wm_sensors::impl::GroupAffinity& affinity);
@@ -34,9 +34,6 @@ wm_sensors::impl::HidChipImplAutoRead::HidChipImplAutoRead(
 wm_sensors::impl::HidChipImplAutoRead::~HidChipImplAutoRead()
 {
 	stop();
-	if (readThread_.joinable()) {
-		readThread_.join();
-	}
 }
 
 void wm_sensors::impl::HidChipImplAutoRead::run()
@@ -49,11 +46,15 @@ void wm_sensors::impl::HidChipImplAutoRead::run()
 void wm_sensors::impl::HidChipImplAutoRead::stop()
 {
 	running_ = false;
+	if (readThread_.joinable()) {
+		readThread_.join();
+	}
 }
 
 void wm_sensors::impl::HidChipImplAutoRead::acknowledgeDataAccess()
 {
-	if (!running_) {
+	// starts the thread once, even if called from several threads
+	if (!running_.exchange(true)) {
 		run();
 	}
 	lastRead_ = std::chrono::steady_clock::now();
@@ -6,6 +6,7 @@
 #include "../../sensor.hxx"
 #include "../../utility/hidapi++/hidapi.hxx"
 
+#include <atomic>
 #include <chrono>
 #include <functional>
 #include <memory>
@@ -38,20 +39,24 @@ namespace wm_sensors::impl {
 		HidChipImplAutoRead(hidapi::device&& dev, std::chrono::milliseconds readInterval);
 
 		virtual bool readData() = 0;
+		/**
+		 * Stops the read thread and waits for it. Derived classes call it from their destructors, because readData()
+		 * uses their members, which are destroyed before the base destructor runs.
+		 */
+		void stop();
 
 	private:
 		HidChipImplAutoRead(const HidChipImplAutoRead&) = delete;
 		HidChipImplAutoRead& operator=(const HidChipImplAutoRead&) = delete;
 
 		void run();
-		void stop();
 
 		void readThread();
 
 		std::thread readThread_;
 		std::chrono::milliseconds readInterval_;
 		std::chrono::steady_clock::time_point lastRead_;
-		bool running_;
+		std::atomic<bool> running_; // set by the refreshing thread, read by the read thread
 	};
 }
 
@@ -3,103 +3,66 @@
 #include "./generic_memory.hxx"
 
 #include "../../utility/string.hxx"
-#include "../../utility/utility.hxx"
 
 #include <spdlog/spdlog.h>
 
 #include <Windows.h>
 
-namespace {
-	const std::chrono::seconds updateInterval{1};
-
-	const char* fractionChannels[] = {"Physical", "Page file"};
-	const char* dataChannels[] = {"Physical total", "Physical available", "Page file total", "Page file available"};
-} // namespace
+#include <cerrno>
 
 wm_sensors::hardware::memory::GenericMemory::GenericMemory()
     : base({"generic", "mem", BusType::Virtual})
+    , status_{}
 {
+	const u32 attrs = attributes::generic_input | attributes::generic_label;
+	channels_.add(SensorType::fraction, attrs, "Physical", &status_.load);
+	channels_.add(SensorType::fraction, attrs, "Page file", &status_.pageFileLoad);
+	channels_.add(SensorType::data, attrs, "Physical total", &status_.totalPhys);
+	channels_.add(SensorType::data, attrs, "Physical available", &status_.availPhys);
+	channels_.add(SensorType::data, attrs, "Page file total", &status_.totalPageFile);
+	channels_.add(SensorType::data, attrs, "Page file available", &status_.availPageFile);
+	channels_.addChip(0, std::chrono::seconds(1));
+
+	refresh();
 }
 
 wm_sensors::SensorChip::Config wm_sensors::hardware::memory::GenericMemory::config() const
 {
-	u32 attrs = attributes::generic_input | attributes::generic_label;
-
-	return {{
-	    {SensorType::fraction,
-	     {{
-	         attrs, // physical load
-	         attrs, // page file load
-	     }}},
-	    {SensorType::data,
-	     {{
-	         attrs, // total phys.
-	         attrs, // avail. phys.
-	         attrs, // total page file
-	         attrs, // avail. page file
-	     }}},
-	}};
+	return channels_.config();
 }
 
 int wm_sensors::hardware::memory::GenericMemory::read(SensorType type, u32 attr, std::size_t channel, double& val) const
 {
-	switch (type) {
-		case SensorType::fraction:
-			update();
-			switch (channel) {
-				case 0: val = status_.load; return 0;
-				case 1: val = 1.0 - static_cast<double>(status_.availPageFile) / static_cast<double>(status_.totalPageFile); return 0;
-				default: return -EOPNOTSUPP;
-			}
-		case SensorType::data:
-			update();
-			switch (channel) {
-				case 0: val = static_cast<double>(status_.totalPhys); return 0;
-				case 1: val = static_cast<double>(status_.availPhys); return 0;
-				case 2: val = static_cast<double>(status_.totalPageFile); return 0;
-				case 3: val = static_cast<double>(status_.availPageFile); return 0;
-				default: return -EOPNOTSUPP;
-			}
-		default: return base::read(type, attr, channel, val);
-	}
+	const int res = channels_.read(type, attr, channel, val);
+	return res == -ENOENT ? base::read(type, attr, channel, val) : res;
 }
 
 int wm_sensors::hardware::memory::GenericMemory::read(
     SensorType type, u32 attr, std::size_t channel, std::string_view& str) const
 {
-	switch (type) {
-		case SensorType::fraction:
-			if (channel < utility::array_size(fractionChannels)) {
-				str = fractionChannels[channel];
-				return 0;
-			}
-			break;
-		case SensorType::data:
-			if (channel < utility::array_size(dataChannels)) {
-				str = dataChannels[channel];
-				return 0;
-			}
-			break;
-		default: break;
-	}
-	return base::read(type, attr, channel, str);
+	const int res = channels_.read(type, attr, channel, str);
+	return res == -ENOENT ? base::read(type, attr, channel, str) : res;
+}
+
+const std::atomic<double>*
+wm_sensors::hardware::memory::GenericMemory::valueSlot(SensorType type, u32 attr, std::size_t channel) const
+{
+	return channels_.valueSlot(type, attr, channel);
 }
 
-void wm_sensors::hardware::memory::GenericMemory::update() const
+void wm_sensors::hardware::memory::GenericMemory::refreshValues() const
 {
-	const auto now = std::chrono::steady_clock::now();
-	if (now > lastUpdate_ + updateInterval) {
-		MEMORYSTATUSEX ms;
-		ms.dwLength = sizeof(ms);
-		if (::GlobalMemoryStatusEx(&ms)) {
-			lastUpdate_ = now;
-			status_.load = static_cast<float>(ms.dwMemoryLoad) / 100.f;
-			status_.totalPhys = ms.ullTotalPhys;
-			status_.availPhys = ms.ullAvailPhys;
-			status_.totalPageFile = ms.ullTotalPageFile;
-			status_.availPageFile = ms.ullAvailPageFile;
-		} else {
-			spdlog::error("GlobalMemoryStatusEx() failed: {}", windowsLastErrorMessage());
-		}
+	MEMORYSTATUSEX ms;
+	ms.dwLength = sizeof(ms);
+	if (::GlobalMemoryStatusEx(&ms)) {
+		status_.load = static_cast<double>(ms.dwMemoryLoad) / 100.;
+		status_.totalPhys = static_cast<double>(ms.ullTotalPhys);
+		status_.availPhys = static_cast<double>(ms.ullAvailPhys);
+		status_.totalPageFile = static_cast<double>(ms.ullTotalPageFile);
+		status_.availPageFile = static_cast<double>(ms.ullAvailPageFile);
+		status_.pageFileLoad = 1.0 - status_.availPageFile / status_.totalPageFile;
+		publish([this] { channels_.publish(*enabledChannels()); });
+	} else {
+		spdlog::error("GlobalMemoryStatusEx() failed: {}", windowsLastErrorMessage());
 	}
 }
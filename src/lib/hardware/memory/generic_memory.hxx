@@ -3,10 +3,9 @@
 #ifndef WM_SENSORS_HARDWARE_MEMORY_GENERIC_HXX
 #define WM_SENSORS_HARDWARE_MEMORY_GENERIC_HXX
 
+#include "../../impl/channel_table.hxx"
 #include "../../sensor.hxx"
 
-#include <chrono>
-
 namespace wm_sensors::hardware::memory {
 	class GenericMemory: public SensorChip {
 		using base = SensorChip;
@@ -18,19 +17,23 @@ namespace wm_sensors::hardware::memory {
 		int read(SensorType type, u32 attr, std::size_t channel, double& val) const override;
 		int read(SensorType type, u32 attr, std::size_t channel, std::string_view& str) const override;
 
+	protected:
+		void refreshValues() const override;
+		const std::atomic<double>* valueSlot(SensorType type, u32 attr, std::size_t channel) const override;
+
 	private:
-		void update() const;
 		DELETE_COPY_CTOR_AND_ASSIGNMENT(GenericMemory)
 
 		struct MemoryStatus {
-			float load;
-			unsigned long long totalPhys;
-			unsigned long long availPhys;
-			unsigned long long totalPageFile;
-			unsigned long long availPageFile;
+			double load;
+			double pageFileLoad;
+			double totalPhys;
+			double availPhys;
+			double totalPageFile;
+			double availPageFile;
 		};
 		mutable MemoryStatus status_;
-		mutable std::chrono::steady_clock::time_point lastUpdate_;
+		wm_sensors::impl::ChannelTable channels_;
 	};
 } // namespace wm_sensors::hardware::memory
 
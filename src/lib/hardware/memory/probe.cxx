@@ -9,6 +9,10 @@ namespace wm_sensors::hardware::memory {
 	class MemoryProbe: public wm_sensors::impl::ChipProbe {
 		// Inherited via ChipProbe
 		virtual bool probe(SensorChipTreeNode& sensorsTree) override;
+		std::string_view name() const override
+		{
+			return "memory";
+		}
 	};
 
 	bool MemoryProbe::probe(SensorChipTreeNode& sensorsTree)
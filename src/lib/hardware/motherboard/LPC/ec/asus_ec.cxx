@@ -3,6 +3,7 @@
 #include "./asus_ec.hxx"
 
 #include "./ec.hxx"
+#include "../../../../impl/channel_table.hxx"
 #include "../../../../utility/utility.hxx"
 #include "../../../../utility/unaligned.hxx"
 
@@ -11,10 +12,8 @@
 #include <algorithm>
 #include <bitset>
 #include <cassert>
-#include <chrono>
 #include <limits>
 #include <map>
-#include <mutex>
 #include <set>
 #include <type_traits>
 #include <vector>
@@ -25,12 +24,6 @@ namespace {
 	using wm_sensors::hardware::motherboard::Model;
 	using wm_sensors::hardware::motherboard::lpc::ec::EC;
 
-	using namespace std::chrono_literals;
-
-	const auto updateTimeout = 1s;
-
-	constexpr const std::size_t invalidIndex = static_cast<std::size_t>(-1);
-
 	template <typename T>
 	constexpr unsigned long bit(T n) requires std::is_integral_v<T>
 	{
@@ -203,23 +196,21 @@ struct wm_sensors::hardware::motherboard::lpc::ec::AsusEC::Impl {
 
 	struct SensorState {
 		const ECSensorInfo* info;
-		int cachedValue;
+		double cachedValue;
 	};
 
-	std::size_t sensorIndex(SensorType type, std::size_t channel) const;
 	void update();
+	void decodeReadBuffer();
 //	void ecBlockRead();
 
 	std::vector<SensorState> state;
-	std::chrono::steady_clock::time_point lastUpdate;
 	std::vector<u16> registers;
 	std::vector<u8> readBuffer;
+	wm_sensors::impl::ChannelTable channels;
 	u8 nrBanks;
-	std::mutex updateMutex;
 };
 
 wm_sensors::hardware::motherboard::lpc::ec::AsusEC::Impl::Impl(Model model)
-	: lastUpdate{std::chrono::steady_clock::now() - 2 * updateTimeout}
 {
 	std::bitset<sensorMax> sensors{boardSensors.at(model)};
 	// we collect all sensors for this board...
@@ -228,7 +219,7 @@ wm_sensors::hardware::motherboard::lpc::ec::AsusEC::Impl::Impl(Model model)
 	for (std::size_t i = 0 ; i < sensors.size(); ++i) {
 		if (sensors.test(i)) {
 			const auto& si = knownECSensors.at(static_cast<ec_sensors>(i));
-			state.push_back({&si, 0});
+			state.push_back({&si, std::numeric_limits<double>::quiet_NaN()});
 			nrRegisters += si.addr.components.size;
 			banks.insert(si.addr.components.bank);
 		}
@@ -252,6 +243,23 @@ wm_sensors::hardware::motherboard::lpc::ec::AsusEC::Impl::Impl(Model model)
 		}
 	}
 
+	const std::map<SensorType, u32> typeAttributes = {
+	    {SensorType::temp, attributes::temp_input | attributes::temp_label},
+	    {SensorType::in, attributes::in_input | attributes::in_label},
+	    {SensorType::curr, attributes::curr_input | attributes::curr_label},
+	    {SensorType::fan, attributes::fan_input | attributes::fan_label},
+	};
+
+	for (const auto& st: state) {
+		channels.add(st.info->type, typeAttributes.at(st.info->type), st.info->label, &st.cachedValue);
+	}
+	channels.addChip(attributes::chip_register_tz, std::chrono::seconds(1));
+
+	decodeReadBuffer();
+}
+
+void wm_sensors::hardware::motherboard::lpc::ec::AsusEC::Impl::decodeReadBuffer()
+{
 	const auto sensorValue = [](const ECSensorInfo& si, const u8* data) -> int {
 		switch (si.addr.components.size) {
 			case 1: return static_cast<s8>(*data);
@@ -269,23 +277,8 @@ wm_sensors::hardware::motherboard::lpc::ec::AsusEC::Impl::Impl(Model model)
 	}
 }
 
-std::size_t wm_sensors::hardware::motherboard::lpc::ec::AsusEC::Impl::sensorIndex(
-    wm_sensors::SensorType type, std::size_t channel) const
-{
-	for (std::size_t i = 0; i < state.size(); i++) {
-		if (state[i].info->type == type) {
-			if (channel == 0)
-				return i;
-			channel--;
-		}
-	}
-	return invalidIndex;
-}
-
 void wm_sensors::hardware::motherboard::lpc::ec::AsusEC::Impl::update()
 {
-	std::lock_guard<std::mutex> lock{updateMutex};
-
 	u8 bank = 0, prevBank;
 	ecBankSwitch(bank, &prevBank);
 
@@ -308,6 +301,7 @@ void wm_sensors::hardware::motherboard::lpc::ec::AsusEC::Impl::update()
 	}
 
 	ecBankSwitch(prevBank, nullptr);
+	decodeReadBuffer();
 }
 
 
@@ -315,6 +309,7 @@ wm_sensors::hardware::motherboard::lpc::ec::AsusEC::AsusEC(motherboard::Model mo
     : base({"ASUS EC", "ec", BusType::ISA})
 	, impl_{std::make_unique<Impl>(model)}
 {
+	publish([this] { impl_->channels.publish(*enabledChannels()); });
 }
 
 wm_sensors::hardware::motherboard::lpc::ec::AsusEC::~AsusEC() = default;
@@ -326,47 +321,36 @@ bool wm_sensors::hardware::motherboard::lpc::ec::AsusEC::isAvailable(motherboard
 
 wm_sensors::SensorChip::Config wm_sensors::hardware::motherboard::lpc::ec::AsusEC::config() const
 {
-	const std::map<SensorType, u32> attributes = {
-		{SensorType::chip, attributes::chip_register_tz},
-		{SensorType::temp, attributes::temp_input | attributes::temp_label},
-		{SensorType::in, attributes::in_input | attributes::in_label},
-		{SensorType::curr, attributes::curr_input | attributes::curr_label},
-		{SensorType::fan, attributes::fan_input | attributes::fan_label},
-	};
-
-	Config res;
-
-	for (const auto& st: impl_->state) {
-		res.sensors[st.info->type].channelAttributes.push_back(attributes.at(st.info->type));
-	}
-
-	res.sensors[SensorType::chip].channelAttributes.push_back(attributes.at(SensorType::chip));
+	return impl_->channels.config();
+}
 
-	return res;
+wm_sensors::SensorChip::ChannelCost
+wm_sensors::hardware::motherboard::lpc::ec::AsusEC::readCost(SensorType /*type*/, std::size_t /*channel*/) const
+{
+	// EC registers are read through the ACPI EC interface, each one takes a handshake with the controller firmware
+	return {ReadCost::Firmware, "refresh"};
 }
 
+void wm_sensors::hardware::motherboard::lpc::ec::AsusEC::refreshValues() const
+{
+	impl_->update();
+	publish([this] { impl_->channels.publish(*enabledChannels()); });
+}
 
 int wm_sensors::hardware::motherboard::lpc::ec::AsusEC::read(
-    SensorType type, u32 /*attr*/, std::size_t channel, double& val) const
+    SensorType type, u32 attr, std::size_t channel, double& val) const
 {
-	if (std::chrono::steady_clock::now() > impl_->lastUpdate + updateTimeout) {
-		impl_->update();
-	}
-	std::size_t ind = impl_->sensorIndex(type, channel);
-	if (ind == invalidIndex) {
-		return -ENOENT;
-	}
-	val = impl_->state[ind].cachedValue;
-	return 0;
+	return impl_->channels.read(type, attr, channel, val);
 }
 
 int wm_sensors::hardware::motherboard::lpc::ec::AsusEC::read(
-    SensorType type, u32 /*attr*/, std::size_t channel, std::string_view& str) const
+    SensorType type, u32 attr, std::size_t channel, std::string_view& str) const
 {
-	std::size_t ind = impl_->sensorIndex(type, channel);
-	if (ind == invalidIndex) {
-		return -ENOENT;
-	}
-	str = impl_->state[ind].info->label;
-	return 0;
+	return impl_->channels.read(type, attr, channel, str);
+}
+
+const std::atomic<double>* wm_sensors::hardware::motherboard::lpc::ec::AsusEC::valueSlot(
+    SensorType type, u32 attr, std::size_t channel) const
+{
+	return impl_->channels.valueSlot(type, attr, channel);
 }
@@ -18,8 +18,14 @@ namespace wm_sensors::hardware::motherboard::lpc::ec {
 		Config config() const override;
 		int read(SensorType type, u32 attr, std::size_t channel, double& val) const override;
 		int read(SensorType type, u32 attr, std::size_t channel, std::string_view& str) const override;
+		ChannelCost readCost(SensorType type, std::size_t channel) const override;
 
 		static bool isAvailable(motherboard::Model model);
+
+	protected:
+		void refreshValues() const override;
+		const std::atomic<double>* valueSlot(SensorType type, u32 attr, std::size_t channel) const override;
+
 	private:
 		DELETE_COPY_CTOR_AND_ASSIGNMENT(AsusEC)
 
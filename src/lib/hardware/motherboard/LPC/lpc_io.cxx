@@ -2,6 +2,7 @@
 
 #include "./lpc_io.hxx"
 
+#include "../../impl/probe_cache.hxx"
 #include "../../impl/ring0.hxx"
 #include "./identification.hxx"
 #include "./port.hxx"
@@ -10,6 +11,10 @@
 #include "./superio/nct677x.hxx"
 #include "./superio/w836xx.hxx"
 
+#include <fmt/format.h>
+#include <spdlog/spdlog.h>
+
+#include <charconv>
 #include <chrono>
 #include <thread>
 
@@ -36,6 +41,27 @@ namespace {
 
 	const u8 fintekVendorIdRegister = 0x23;
 	const u8 IT87ChipVersionRegister = 0x22;
+
+	using wm_sensors::hardware::motherboard::lpc::Chip;
+
+	bool hasNuvotonIOSpaceLock(Chip chip)
+	{
+		return chip == Chip::NCT6791D || chip == Chip::NCT6792D || chip == Chip::NCT6792DA || chip == Chip::NCT6793D ||
+		       chip == Chip::NCT6795D || chip == Chip::NCT6796D || chip == Chip::NCT6796DR || chip == Chip::NCT6798D ||
+		       chip == Chip::NCT6797D;
+	}
+
+	bool isFintek(Chip chip)
+	{
+		return chip == Chip::F71858 || chip == Chip::F71862 || chip == Chip::F71869 || chip == Chip::F71878AD ||
+		       chip == Chip::F71869A || chip == Chip::F71882 || chip == Chip::F71889AD || chip == Chip::F71889ED ||
+		       chip == Chip::F71889F || chip == Chip::F71808E;
+	}
+
+	std::string cacheKey(const wm_sensors::hardware::motherboard::lpc::SingleBankPort& port)
+	{
+		return fmt::format("lpc/{:x}", port.regs().indexRegOffset);
+	}
 } // namespace
 
 wm_sensors::hardware::motherboard::lpc::LpcIo::LpcIo(MotherboardId board)
@@ -51,13 +77,164 @@ wm_sensors::hardware::motherboard::lpc::LpcIo::~LpcIo() = default;
 
 void wm_sensors::hardware::motherboard::lpc::LpcIo::detect(MotherboardId board)
 {
+	auto& cache = hardware::impl::ProbeCache::instance();
 	for (const auto& p: registerPorts) {
 		const SingleBankPort port{p};
 
-		if (detectWinbondFintek(board, port)) continue;
-		if (detectIT87(board, port)) continue;
-		if (detectSmsc(board, port)) continue;
+		const auto cached = cache.get(cacheKey(port));
+		const auto cachedChip = cached ? DetectedChip::parse(*cached) : std::nullopt;
+		if (cachedChip && detectCached(board, port, *cachedChip)) continue;
+
+		detected_.reset();
+		if (!detectWinbondFintek(board, port) && !detectIT87(board, port)) {
+			detectSmsc(board, port);
+		}
+		// ports without a chip are not cached, probing them is cheap
+		if (detected_) {
+			cache.set(cacheKey(port), detected_->toString());
+		} else if (cached) {
+			cache.remove(cacheKey(port));
+		}
+	}
+}
+
+bool wm_sensors::hardware::motherboard::lpc::LpcIo::detectCached(
+    MotherboardId board, const SingleBankPort& port, const DetectedChip& cached)
+{
+	// the chip id is enough to tell the cached chip is still there, addresses are then taken from the cache
+	if (cached.ite) {
+		IT87EnterExit guard{port};
+		if (port.readWord(chipIdRegister) != cached.id) {
+			return false;
+		}
+		addChip(board, port, cached);
+	} else {
+		WinbondNuvotonFintekEnterExit guard{port};
+		const u16 id = static_cast<u16>((port.readByte(chipIdRegister) << 8) | port.readByte(chipRevisionRegister));
+		if (id != cached.id) {
+			return false;
+		}
+		port.select(cached.logicalDeviceNumber);
+		if (hasNuvotonIOSpaceLock(cached.chip)) {
+			nuvotonDisableIOSpaceLock(port);
+		}
+		addChip(board, port, cached);
 	}
+	spdlog::debug("Using cached SuperIO chip {} at {:#x}", chip_name(cached.chip), cached.address);
+	return true;
+}
+
+void wm_sensors::hardware::motherboard::lpc::LpcIo::addChip(
+    MotherboardId board, const SingleBankPort& port, const DetectedChip& c)
+{
+	switch (c.chip) {
+		case Chip::IT8620E:
+		case Chip::IT8628E:
+		case Chip::IT8631E:
+		case Chip::IT8655E:
+		case Chip::IT8665E:
+		case Chip::IT8686E:
+		case Chip::IT8688E:
+		case Chip::IT8689E:
+		case Chip::IT8705F:
+		case Chip::IT8712F:
+		case Chip::IT8716F:
+		case Chip::IT8718F:
+		case Chip::IT8720F:
+		case Chip::IT8721F:
+		case Chip::IT8726F:
+		case Chip::IT8728F:
+		case Chip::IT8771E:
+		case Chip::IT8772E:
+		case Chip::IT879XE: {
+			superioChips_.push_back(std::make_unique<superio::IT87xx>(board, c.chip, c.address, c.gpioAddress, c.version));
+			break;
+		}
+		case Chip::W83627DHG:
+		case Chip::W83627DHGP:
+		case Chip::W83627EHF:
+		case Chip::W83627HF:
+		case Chip::W83627THF:
+		case Chip::W83667HG:
+		case Chip::W83667HGB:
+		case Chip::W83687THF: {
+			superioChips_.push_back(std::make_unique<superio::W836xx>(board, c.chip, c.revision, c.address));
+			break;
+		}
+		case Chip::NCT610XD:
+		case Chip::NCT6771F:
+		case Chip::NCT6776F:
+		case Chip::NCT6779D:
+		case Chip::NCT6791D:
+		case Chip::NCT6792D:
+		case Chip::NCT6792DA:
+		case Chip::NCT6793D:
+		case Chip::NCT6795D:
+		case Chip::NCT6796D:
+		case Chip::NCT6796DR:
+		case Chip::NCT6797D:
+		case Chip::NCT6798D:
+		case Chip::NCT6687D:
+		case Chip::NCT6683D: {
+			superioChips_.push_back(std::make_unique<superio::Nct67xx>(board, c.chip, c.revision, c.address, port));
+			break;
+		}
+		case Chip::F71858:
+		case Chip::F71862:
+		case Chip::F71869:
+		case Chip::F71878AD:
+		case Chip::F71869A:
+		case Chip::F71882:
+		case Chip::F71889AD:
+		case Chip::F71889ED:
+		case Chip::F71889F:
+		case Chip::F71808E: {
+			superioChips_.push_back(std::make_unique<superio::F718xx>(board, c.chip, c.address));
+			break;
+		}
+		default:
+			return;
+	}
+	detected_ = c;
+}
+
+std::string wm_sensors::hardware::motherboard::lpc::LpcIo::DetectedChip::toString() const
+{
+	return fmt::format("{} {:x} {:x} {:x} {:x} {:x} {:x} {:x}", ite ? "ite" : "winbond",
+	    static_cast<unsigned>(chip), id, revision, logicalDeviceNumber, address, gpioAddress, version);
+}
+
+std::optional<wm_sensors::hardware::motherboard::lpc::LpcIo::DetectedChip>
+wm_sensors::hardware::motherboard::lpc::LpcIo::DetectedChip::parse(std::string_view str)
+{
+	const auto next = [&str](auto& field) {
+		while (!str.empty() && str.front() == ' ') {
+			str.remove_prefix(1);
+		}
+		unsigned val;
+		const auto [ptr, ec] = std::from_chars(str.data(), str.data() + str.size(), val, 16);
+		if (ec != std::errc{}) {
+			return false;
+		}
+		str.remove_prefix(static_cast<std::size_t>(ptr - str.data()));
+		field = static_cast<std::remove_reference_t<decltype(field)>>(val);
+		return true;
+	};
+
+	DetectedChip res;
+	if (str.starts_with("ite ")) {
+		res.ite = true;
+	} else if (str.starts_with("winbond ")) {
+		res.ite = false;
+	} else {
+		return {};
+	}
+	str.remove_prefix(str.find(' '));
+	if (next(res.chip) && next(res.id) && next(res.revision) && next(res.logicalDeviceNumber) && next(res.address) &&
+	    next(res.gpioAddress) && next(res.version)) {
+		return res;
+	}
+	return {};
 }
 
 void wm_sensors::hardware::motherboard::lpc::LpcIo::reportUnknownChip(const SingleBankPort& /*port*/, std::string_view /*type*/, int /*chip*/)
@@ -155,7 +332,7 @@ bool wm_sensors::hardware::motherboard::lpc::LpcIo::detectIT87(MotherboardId boa
 			return false;
 		}
 
-		superioChips_.push_back(std::make_unique<superio::IT87xx>(board, chip, address, gpioAddress, version));
+		addChip(board, port, {true, chip, chipId, 0, IT87EnvironmentControllerLdn, address, gpioAddress, version});
 		return true;
 	}
 
@@ -540,9 +717,7 @@ bool wm_sensors::hardware::motherboard::lpc::LpcIo::detectWinbondFintek(Motherbo
 		u16 vendorId = port.readWord(fintekVendorIdRegister);
 
 		// disable the hardware monitor i/o space lock on NCT679XD chips
-		if (address == verify && (chip == Chip::NCT6791D || chip == Chip::NCT6792D || chip == Chip::NCT6792DA ||
-		                          chip == Chip::NCT6793D || chip == Chip::NCT6795D || chip == Chip::NCT6796D ||
-		                          chip == Chip::NCT6796DR || chip == Chip::NCT6798D || chip == Chip::NCT6797D)) {
+		if (address == verify && hasNuvotonIOSpaceLock(chip)) {
 			nuvotonDisableIOSpaceLock(port);
 		}
 
@@ -572,65 +747,20 @@ bool wm_sensors::hardware::motherboard::lpc::LpcIo::detectWinbondFintek(Motherbo
 			return false;
 		}
 
-		switch (chip) {
-			case Chip::W83627DHG:
-			case Chip::W83627DHGP:
-			case Chip::W83627EHF:
-			case Chip::W83627HF:
-			case Chip::W83627THF:
-			case Chip::W83667HG:
-			case Chip::W83667HGB:
-			case Chip::W83687THF: {
-				superioChips_.push_back(std::make_unique<superio::W836xx>(board, chip, revision, address));
-				break;
-			}
-			case Chip::NCT610XD:
-			case Chip::NCT6771F:
-			case Chip::NCT6776F:
-			case Chip::NCT6779D:
-			case Chip::NCT6791D:
-			case Chip::NCT6792D:
-			case Chip::NCT6792DA:
-			case Chip::NCT6793D:
-			case Chip::NCT6795D:
-			case Chip::NCT6796D:
-			case Chip::NCT6796DR:
-			case Chip::NCT6797D:
-			case Chip::NCT6798D:
-			case Chip::NCT6687D:
-			case Chip::NCT6683D: {
-				superioChips_.push_back(std::make_unique<superio::Nct67xx>(board, chip, revision, address, port));
-				break;
-			}
-			case Chip::F71858:
-			case Chip::F71862:
-			case Chip::F71869:
-			case Chip::F71878AD:
-			case Chip::F71869A:
-			case Chip::F71882:
-			case Chip::F71889AD:
-			case Chip::F71889ED:
-			case Chip::F71889F:
-			case Chip::F71808E: {
-				if (vendorId != fintekVendorId) {
-// 					_report.Append("Chip ID: 0x");
-// 					_report.AppendLine(chip.ToString("X"));
-// 					_report.Append("Chip revision: 0x");
-// 					_report.AppendLine(revision.ToString("X", CultureInfo.InvariantCulture));
-// 					_report.Append("Error: Invalid vendor ID 0x");
-// 					_report.AppendLine(vendorId.ToString("X", CultureInfo.InvariantCulture));
-// 					_report.AppendLine();
-
-					return false;
-				}
-
-				superioChips_.push_back(std::make_unique<superio::F718xx>(board, chip, address));
-				break;
-			}
-			default:
-				break;
+		if (isFintek(chip) && vendorId != fintekVendorId) {
+// 			_report.Append("Chip ID: 0x");
+// 			_report.AppendLine(chip.ToString("X"));
+// 			_report.Append("Chip revision: 0x");
+// 			_report.AppendLine(revision.ToString("X", CultureInfo.InvariantCulture));
+// 			_report.Append("Error: Invalid vendor ID 0x");
+// 			_report.AppendLine(vendorId.ToString("X", CultureInfo.InvariantCulture));
+// 			_report.AppendLine();
+
+			return false;
 		}
 
+		addChip(board, port,
+		    {false, chip, static_cast<u16>((id << 8) | revision), revision, logicalDeviceNumber, address, 0, 0});
 		return true;
 	}
 
@@ -2,9 +2,14 @@
 #ifndef WM_SENSORS_LIB_HARDWARE_MOTHERPOARD_LPC_LPCIO_HXX
 #define WM_SENSORS_LIB_HARDWARE_MOTHERPOARD_LPC_LPCIO_HXX
 
+#include "../../../stdint.hxx"
 #include "../identification.hxx"
+#include "./identification.hxx"
 
 #include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
 #include <vector>
 
 namespace wm_sensors::hardware::motherboard::lpc {
@@ -27,7 +32,24 @@ namespace wm_sensors::hardware::motherboard::lpc {
 		}
 
 	private:
+		/** Detected chip, stored in the probe cache */
+		struct DetectedChip {
+			bool ite; // entered with the ITE sequence, Winbond/Nuvoton/Fintek one otherwise
+			Chip chip;
+			u16 id; // chip id register value(s), validated on warm starts
+			u8 revision;
+			u8 logicalDeviceNumber;
+			u16 address;
+			u16 gpioAddress;
+			u8 version;
+
+			std::string toString() const;
+			static std::optional<DetectedChip> parse(std::string_view str);
+		};
+
 		void detect(MotherboardId board);
+		bool detectCached(MotherboardId board, const SingleBankPort& port, const DetectedChip& cached);
+		void addChip(MotherboardId board, const SingleBankPort& port, const DetectedChip& chip);
 		bool detectIT87(MotherboardId board, const SingleBankPort& port);
 		bool detectSmsc(MotherboardId board, const SingleBankPort& port);
 		bool detectWinbondFintek(MotherboardId board, const SingleBankPort& port);
@@ -35,6 +57,7 @@ namespace wm_sensors::hardware::motherboard::lpc {
 		void reportUnknownChip(const SingleBankPort& port, std::string_view type, int chip);
 
 		std::vector<std::unique_ptr<SuperIOSensorChip>> superioChips_;
+		std::optional<DetectedChip> detected_;
 	};
 } // namespace wm_sensors::hardware::motherboard::lpc
 
@@ -160,7 +160,7 @@ wm_sensors::hardware::motherboard::lpc::superio::Nct67xx::channelCount(Chip chip
 	return res;
 }
 
-bool wm_sensors::hardware::motherboard::lpc::superio::Nct67xx::isNuvotonVendor()
+bool wm_sensors::hardware::motherboard::lpc::superio::Nct67xx::isNuvotonVendor() const
 {
 	if (chip() == Chip::NCT6687D || chip() == Chip::NCT6683D) {
 		return true;
@@ -452,7 +452,7 @@ void wm_sensors::hardware::motherboard::lpc::superio::Nct67xx::writePWM(std::siz
 	}
 }
 
-bool wm_sensors::hardware::motherboard::lpc::superio::Nct67xx::disableIOSpaceLock()
+bool wm_sensors::hardware::motherboard::lpc::superio::Nct67xx::disableIOSpaceLock() const
 {
 	const auto chip = this->chip();
 	if (chip != Chip::NCT6791D && chip != Chip::NCT6792D && chip != Chip::NCT6792DA && chip != Chip::NCT6793D &&
@@ -471,7 +471,7 @@ bool wm_sensors::hardware::motherboard::lpc::superio::Nct67xx::disableIOSpaceLoc
 	return true;
 }
 
-bool wm_sensors::hardware::motherboard::lpc::superio::Nct67xx::beginRead()
+bool wm_sensors::hardware::motherboard::lpc::superio::Nct67xx::beginRead() const
 {
 	return base::beginRead() && disableIOSpaceLock();
 }
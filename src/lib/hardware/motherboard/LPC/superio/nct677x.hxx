@@ -34,12 +34,12 @@ namespace wm_sensors::hardware::motherboard::lpc::superio {
 		void restoreDefaultFanPwmControl(std::size_t channel);
 
 		// one-time setup functions
-		bool isNuvotonVendor();
+		bool isNuvotonVendor() const;
 		void setupChipParameters(Chip chip);
 
-		bool disableIOSpaceLock();
+		bool disableIOSpaceLock() const;
 
-		bool beginRead() override;
+		bool beginRead() const override;
 
 		enum class Source : u8
 		{
@@ -7,6 +7,7 @@
 #include "./super_io_channel_config.hxx"
 
 #include <algorithm>
+#include <limits>
 
 namespace {
 	using namespace wm_sensors;
@@ -66,12 +67,32 @@ wm_sensors::hardware::motherboard::lpc::SuperIOSensorChip::SuperIOSensorChip(
     , chip_{chip}
     , address_{address}
 {
-	validateConfig();
-
 	for (std::size_t i = 0; i < static_cast<std::size_t>(SensorType::max); ++i) {
 		auto it = nrChannels.find(static_cast<SensorType>(i));
 		nrChannels_[i] = it != nrChannels.end() ? it->second : 0;
+		values_[i].assign(nrChannels_[i], std::numeric_limits<double>::quiet_NaN());
 	}
+
+	validateConfig();
+
+	const auto addChannels = [this](SensorType type, const auto& configs) {
+		const u32 attrs = sensorAttributes[utility::to_underlying(type)];
+		const auto& values = values_[utility::to_underlying(type)];
+		for (const auto& cc: configs) {
+			channels_.add(type, attrs, cc.label, &values[cc.sourceIndex]);
+		}
+	};
+
+	addChannels(SensorType::fan, config_.fan);
+	addChannels(SensorType::temp, config_.temperature);
+	addChannels(SensorType::pwm, config_.pwm);
+	for (const auto& cc: config_.voltage) {
+		// Voltage = value + (value - Vf) * Ri / Rf.
+		const double k = static_cast<double>(cc.ri) / static_cast<double>(cc.rf);
+		channels_.add(SensorType::in, sensorAttributes[utility::to_underlying(SensorType::in)], cc.label,
+		    &values_[utility::to_underlying(SensorType::in)][cc.sourceIndex], 1. + k, -cc.vf * k);
+	}
+	channels_.addChip(0, std::chrono::seconds(1));
 }
 
 wm_sensors::hardware::motherboard::lpc::Chip wm_sensors::hardware::motherboard::lpc::SuperIOSensorChip::chip() const
@@ -88,93 +109,48 @@ void wm_sensors::hardware::motherboard::lpc::SuperIOSensorChip::writeGPIO(u8 /*i
 
 wm_sensors::SensorChip::Config wm_sensors::hardware::motherboard::lpc::SuperIOSensorChip::config() const
 {
-	SensorChip::Config res;
-	if (config_.fan.size()) {
-		res.sensors[SensorType::fan].channelAttributes.assign(
-		    config_.fan.size(), sensorAttributes[utility::to_underlying(SensorType::fan)]);
-	}
-	if (config_.temperature.size()) {
-		res.sensors[SensorType::temp].channelAttributes.assign(
-		    config_.temperature.size(), sensorAttributes[utility::to_underlying(SensorType::temp)]);
-	}
-	if (config_.voltage.size()) {
-		res.sensors[SensorType::voltage].channelAttributes.assign(
-		    config_.voltage.size(), sensorAttributes[utility::to_underlying(SensorType::voltage)]);
+	return channels_.config();
+}
+
+wm_sensors::SensorChip::RefreshDomain wm_sensors::hardware::motherboard::lpc::SuperIOSensorChip::refreshDomain() const
+{
+	return {BusType::ISA, impl::systemLockBit(impl::GlobalMutex::ISABus)};
+}
+
+void wm_sensors::hardware::motherboard::lpc::SuperIOSensorChip::refreshValues() const
+{
+	if (!beginRead()) {
+		return;
 	}
-	if (config_.pwm.size()) {
-		res.sensors[SensorType::pwm].channelAttributes.assign(
-		    config_.pwm.size(), sensorAttributes[utility::to_underlying(SensorType::pwm)]);
+
+	for (const SensorType type: {SensorType::temp, SensorType::fan, SensorType::in, SensorType::pwm}) {
+		auto& values = values_[utility::to_underlying(type)];
+		if (!values.empty()) {
+			readSIO(type, 0, values.size(), values.data());
+		}
 	}
 
-	return res;
+	endRead();
+
+	publish([this] { channels_.publish(*enabledChannels()); });
 }
 
 int wm_sensors::hardware::motherboard::lpc::SuperIOSensorChip::read(
     SensorType type, u32 attr, std::size_t channel, double& val) const
 {
-	switch (type) {
-		case SensorType::temp:
-			if (attr == attributes::temp_input) {
-				readSIO(type, config_.temperature[channel].sourceIndex, 1, &val);
-				return 0;
-			}
-			break;
-		case SensorType::fan:
-			if (attr == attributes::fan_input) {
-				readSIO(type, config_.fan[channel].sourceIndex, 1, &val);
-				return 0;
-			}
-			break;
-		case SensorType::in:
-			if (attr == attributes::in_input) {
-				double v;
-				const auto& cc = config_.voltage[channel];
-				readSIO(type, cc.sourceIndex, 1, &v);
-				// Voltage = value + (value - Vf) * Ri / Rf.
-				val = v + (v - cc.vf) * cc.ri / cc.rf;
-				return 0;
-			}
-			break;
-		case SensorType::pwm:
-			if (attr == attributes::pwm_input) {
-				readSIO(type, config_.pwm[channel].sourceIndex, 1, &val);
-				return 0;
-			}
-		default: break;
-	}
-	return -EOPNOTSUPP;
+	return channels_.read(type, attr, channel, val);
+}
+
+const std::atomic<double>* wm_sensors::hardware::motherboard::lpc::SuperIOSensorChip::valueSlot(
+    SensorType type, u32 attr, std::size_t channel) const
+{
+	return channels_.valueSlot(type, attr, channel);
 }
 
 int wm_sensors::hardware::motherboard::lpc::SuperIOSensorChip::read(
     SensorType type, u32 attr, std::size_t channel, std::string_view& str) const
 {
-	switch (type) {
-		case SensorType::temp:
-			if (attr == attributes::temp_label) {
-				str = config_.temperature[channel].label;
-				return 0;
-			}
-			break;
-		case SensorType::fan:
-			if (attr == attributes::fan_label) {
-				str = config_.fan[channel].label;
-				return 0;
-			}
-			break;
-		case SensorType::in:
-			if (attr == attributes::in_label) {
-				str = config_.voltage[channel].label;
-				return 0;
-			}
-			break;
-		case SensorType::pwm:
-			if (attr == attributes::pwm_label) {
-				str = config_.pwm[channel].label;
-				return 0;
-			}
-		default: break;
-	}
-	return -EOPNOTSUPP;
+	return channels_.read(type, attr, channel, str);
 }
 
 int wm_sensors::hardware::motherboard::lpc::SuperIOSensorChip::write(
@@ -187,12 +163,12 @@ int wm_sensors::hardware::motherboard::lpc::SuperIOSensorChip::write(
 	return -EOPNOTSUPP;
 }
 
-bool wm_sensors::hardware::motherboard::lpc::SuperIOSensorChip::beginRead()
+bool wm_sensors::hardware::motherboard::lpc::SuperIOSensorChip::beginRead() const
 {
 	return impl::Ring0::instance().acquireMutex(impl::GlobalMutex::ISABus, std::chrono::milliseconds(10));
 }
 
-void wm_sensors::hardware::motherboard::lpc::SuperIOSensorChip::endRead()
+void wm_sensors::hardware::motherboard::lpc::SuperIOSensorChip::endRead() const
 {
 	impl::Ring0::instance().releaseMutex(impl::GlobalMutex::ISABus);
 }
@@ -208,25 +184,25 @@ void wm_sensors::hardware::motherboard::lpc::SuperIOSensorChip::endWrite()
 }
 
 void wm_sensors::hardware::motherboard::lpc::SuperIOSensorChip::validateConfig(){
-	const auto findMaxChannel = [](const auto& configs) {
-		return std::max_element(configs.begin(), configs.end(), [](const auto& l, const auto& r) {
-			return l.sourceIndex < r.sourceIndex;
-		})->sourceIndex;
+	// channels refer to values_ by source index, hence every index has to be within the chip channel count
+	const auto isValid = [](const auto& configs, std::size_t count) {
+		return std::all_of(
+		    configs.begin(), configs.end(), [count](const auto& c) { return c.sourceIndex < count; });
 	};
-	
-	if (findMaxChannel(config_.fan) > nrChannels_[utility::to_underlying(SensorType::fan)]) {
+
+	if (!isValid(config_.fan, nrChannels(SensorType::fan))) {
 		throw std::runtime_error("Super I/O chip config invalid for fans");
 	}
 
-	if (findMaxChannel(config_.temperature) > nrChannels_[utility::to_underlying(SensorType::temp)]) {
+	if (!isValid(config_.temperature, nrChannels(SensorType::temp))) {
 		throw std::runtime_error("Super I/O chip config invalid for temperatures");
 	}
 
-	if (findMaxChannel(config_.pwm) > nrChannels_[utility::to_underlying(SensorType::pwm)]) {
+	if (!isValid(config_.pwm, nrChannels(SensorType::pwm))) {
 		throw std::runtime_error("Super I/O chip config invalid for PWMs");
 	}
 
-	if (findMaxChannel(config_.voltage) > nrChannels_[utility::to_underlying(SensorType::in)]) {
+	if (!isValid(config_.voltage, nrChannels(SensorType::in))) {
 		throw std::runtime_error("Super I/O chip config invalid for voltages");
 	}
 }
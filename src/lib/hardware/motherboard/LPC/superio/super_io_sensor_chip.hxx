@@ -4,6 +4,7 @@
 
 #include "../identification.hxx"
 #include "../../identification.hxx"
+#include "../../../../impl/channel_table.hxx"
 #include "../../../../sensor.hxx"
 
 #include <optional>
@@ -56,8 +57,10 @@ namespace wm_sensors::hardware::motherboard::lpc {
 		int read(SensorType type, u32 attr, std::size_t channel, double& val) const final override;
 		int read(SensorType type, u32 attr, std::size_t channel, std::string_view& str) const final override;
 		int write(SensorType type, u32 attr, std::size_t channel, double val) final override;
+		RefreshDomain refreshDomain() const final override;
 
 	protected:
+		void refreshValues() const final override;
 		SuperIOSensorChip(
 		    MotherboardId board, lpc::Chip chip, u16 address, const std::map<SensorType, std::size_t>& nrChannels);
 
@@ -67,8 +70,8 @@ namespace wm_sensors::hardware::motherboard::lpc {
 		}
 
 		// default implementation acquires the global ISA mutex
-		virtual bool beginRead();
-		virtual void endRead();
+		virtual bool beginRead() const;
+		virtual void endRead() const;
 
 		// default implementation calls the -read counterpart
 		virtual bool beginWrite();
@@ -76,6 +79,8 @@ namespace wm_sensors::hardware::motherboard::lpc {
 
 		void validateConfig();
 
+		const std::atomic<double>* valueSlot(SensorType type, u32 attr, std::size_t channel) const final override;
+
 	private:
 		DELETE_COPY_CTOR_AND_ASSIGNMENT(SuperIOSensorChip)
 
@@ -83,6 +88,9 @@ namespace wm_sensors::hardware::motherboard::lpc {
 		lpc::Chip chip_;
 		u16 address_;
 		std::size_t nrChannels_[static_cast<unsigned>(SensorType::max)];
+		// raw values from the last refresh(), indexed by the chip source index
+		mutable std::vector<double> values_[static_cast<unsigned>(SensorType::max)];
+		wm_sensors::impl::ChannelTable channels_;
 	};
 }
 
@@ -20,6 +20,15 @@ namespace wm_sensors::hardware::motherboard {
 
 		// Inherited via ChipProbe
 		bool probe(SensorChipTreeNode& sensorsTree) override;
+		std::string_view name() const override
+		{
+			return "motherboard";
+		}
+		// SuperIO and EC detection is slow
+		bool deferrable() const override
+		{
+			return true;
+		}
 	};
 } // namespace wm_sensors::hardware::motherboard
 
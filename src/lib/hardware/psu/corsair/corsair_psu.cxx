@@ -5,10 +5,13 @@
 
 #include "./usb_api.hxx"
 
+#include "../../../impl/channel_table.hxx"
 #include "../../../wm_sensor_types.hxx"
 #include "../../impl/usbhid_chip.hxx"
 
 #include <algorithm>
+#include <array>
+#include <limits>
 #include <map>
 
 namespace {
@@ -46,15 +49,58 @@ struct wm_sensors::hardware::psu::Corsair::Impl {
 	DELETE_COPY_CTOR_AND_ASSIGNMENT(Impl)
 
 	corsair::CorsairUSBDevice device;
+	// read by initialize()
 	corsair::CorsairUSBDevice::Criticals criticals;
 	unsigned optionalCommands;
+
+	// values read by the last refresh(), NaN if unavailable
+	struct Readings {
+		std::array<double, 2> temp;
+		std::array<double, 4> in;
+		std::array<double, 4> curr;
+		std::array<double, 4> power;
+		std::array<double, 1> fan;
+		std::array<double, 2> duration;
+	} readings;
+
+	wm_sensors::impl::ChannelTable channels;
 };
 
 wm_sensors::hardware::psu::Corsair::Impl::Impl(hidapi::device&& dev)
     : device{std::move(dev)}
-    , criticals{device.criticals()}
-    , optionalCommands{device.optionalCommands()}
+    , criticals{}
+    , optionalCommands{0}
 {
+	using namespace attributes;
+
+	const auto add = [this](SensorType type, auto& values, const std::initializer_list<u32>& attrs,
+	                     const std::initializer_list<const char*>& labels) {
+		values.fill(std::numeric_limits<double>::quiet_NaN());
+		auto label = labels.begin();
+		auto value = values.begin();
+		for (u32 a: attrs) {
+			channels.add(type, a, *label++, &*value++);
+		}
+	};
+
+	add(SensorType::temp, readings.temp, {temp_input | temp_label | temp_crit, temp_input | temp_label | temp_crit},
+	    {"VRM", "Case"});
+	add(SensorType::in, readings.in,
+	    {in_input | in_label, in_input | in_label | in_crit | in_lcrit, in_input | in_label | in_crit | in_lcrit,
+	     in_input | in_label | in_crit | in_lcrit},
+	    {"Input", "+12V", "+5V", "+3.3V"});
+	add(SensorType::curr, readings.curr,
+	    {curr_input | curr_label, curr_input | curr_label | curr_crit, curr_input | curr_label | curr_crit,
+	     curr_input | curr_label | curr_crit},
+	    {"Input", "+12V", "+5V", "+3.3V"});
+	add(SensorType::power, readings.power,
+	    {power_input | power_label, power_input | power_label, power_input | power_label, power_input | power_label},
+	    {"Total", "+12V", "+5V", "+3.3V"});
+	add(SensorType::fan, readings.fan, {fan_input | fan_label}, {"PSU"});
+	add(SensorType::duration, readings.duration, {duration_input | duration_label, duration_input | duration_label},
+	    {"Uptime", "Total Uptime"});
+	// each reading is a separate HID transaction
+	channels.addChip(0, std::chrono::seconds(2));
 }
 
 wm_sensors::hardware::psu::Corsair::~Corsair() = default;
@@ -67,66 +113,54 @@ wm_sensors::hardware::psu::Corsair::Corsair(hidapi::device&& dev)
 
 wm_sensors::SensorChip::Config wm_sensors::hardware::psu::Corsair::config() const
 {
-	using namespace attributes;
+	return impl_->channels.config();
+}
 
-	return {
-	    {{SensorType::temp, {{temp_input | temp_label | temp_crit, temp_input | temp_label | temp_crit}}},
-	     {SensorType::in,
-	      {{in_input | in_label, in_input | in_label | in_crit | in_lcrit, in_input | in_label | in_crit | in_lcrit,
-	        in_input | in_label | in_crit | in_lcrit}}},
-	     {SensorType::curr,
-	      {{curr_input | curr_label, curr_input | curr_label | curr_crit, curr_input | curr_label | curr_crit,
-	        curr_input | curr_label | curr_crit}}},
-	     {SensorType::power,
-	      {{power_input | power_label, power_input | power_label, power_input | power_label,
-	        power_input | power_label}}},
-	     {SensorType::fan, {{fan_input | fan_label}}},
-	     {SensorType::duration, {{duration_input | duration_label, duration_input | duration_label}}}}};
+void wm_sensors::hardware::psu::Corsair::initialize() const
+{
+	impl_->device.init();
+	impl_->criticals = impl_->device.criticals();
+	impl_->optionalCommands = impl_->device.optionalCommands();
 }
 
-double wm_sensors::hardware::psu::Corsair::calcInCurr() const
+void wm_sensors::hardware::psu::Corsair::refreshValues() const
 {
-	std::optional<double> watts = impl_->device.value(corsair::CorsairUSBDevice::Command::TOTAL_WATTS, 0);
-	std::optional<double> volts = impl_->device.value(corsair::CorsairUSBDevice::Command::IN_VOLTS, 0);
+	using OptionalCommands = corsair::CorsairUSBDevice::OptionalCommands;
+	using Command = corsair::CorsairUSBDevice::Command;
+
+	auto& device = impl_->device;
+	auto& r = impl_->readings;
+	const auto value = [&device](Command cmd, u8 rail) {
+		return device.value(cmd, rail).value_or(std::numeric_limits<double>::quiet_NaN());
+	};
+
+	r.temp[0] = value(Command::TEMP0, 0);
+	r.temp[1] = value(Command::TEMP1, 1);
+	r.fan[0] = value(Command::FAN_RPM, 0);
+	r.in[0] = value(Command::IN_VOLTS, 0);
+	r.power[0] = value(Command::TOTAL_WATTS, 0);
+	for (u8 rail = 0; rail < 3; ++rail) {
+		r.in[rail + 1u] = value(Command::RAIL_VOLTS, rail);
+		r.curr[rail + 1u] = value(Command::RAIL_AMPS, rail);
+		r.power[rail + 1u] = value(Command::RAIL_WATTS, rail);
+	}
+	r.curr[0] = (impl_->optionalCommands & OptionalCommands::InputCurrent) ? value(Command::IN_AMPS, 0) : calcInCurr();
+	r.duration[0] = value(Command::UPTIME, 0);
+	r.duration[1] = value(Command::TOTAL_UPTIME, 0);
+
+	publish([this] { impl_->channels.publish(*enabledChannels()); });
+}
 
+double wm_sensors::hardware::psu::Corsair::calcInCurr() const
+{
 	/* most of these PSUs have an average efficiency of 92%, so put it in there */
-	return watts.value_or(std::numeric_limits<float>::quiet_NaN()) /
-	       volts.value_or(std::numeric_limits<float>::quiet_NaN()) / 0.92;
+	return impl_->readings.power[0] / impl_->readings.in[0] / 0.92;
 }
 
 int wm_sensors::hardware::psu::Corsair::read(
     SensorType type, u32 attr, std::size_t channel, std::string_view& str) const
 {
-	using labels_array = std::vector<std::string_view>;
-	static const labels_array labelsTemp{"VRM", "Case"};
-	static const labels_array labelsIn{"Input", "+12V", "+5V", "+3.3V"};
-	static const labels_array labelsCurr{"Input", "+12V", "+5V", "+3.3V"};
-	static const labels_array labelsPower{"Total", "+12V", "+5V", "+3.3V"};
-	static const labels_array labelsFan{"PSU"};
-	static const labels_array labelsDuration{"Uptime", "Total Uptime"};
-
-	using namespace attributes;
-
-	if (type == SensorType::temp && attr == temp_label && channel < labelsTemp.size()) {
-		str = labelsTemp[channel];
-		return 0;
-	} else if (type == SensorType::fan && attr == fan_label && channel < labelsFan.size()) {
-		str = labelsFan[channel];
-		return 0;
-	} else if (type == SensorType::power && attr == power_label && channel < labelsPower.size()) {
-		str = labelsPower[channel];
-		return 0;
-	} else if (type == SensorType::in && attr == in_label && channel < labelsIn.size()) {
-		str = labelsIn[channel];
-		return 0;
-	} else if (type == SensorType::curr && attr == curr_label && channel < labelsCurr.size()) {
-		str = labelsCurr[channel];
-		return 0;
-	} else if (type == SensorType::duration && attr == curr_label && channel < labelsDuration.size()) {
-		str = labelsDuration[channel];
-		return 0;
-	}
-	return -EOPNOTSUPP;
+	return impl_->channels.read(type, attr, channel, str);
 }
 
 wm_sensors::SensorChip::VisibilityFlags
@@ -138,7 +172,8 @@ wm_sensors::hardware::psu::Corsair::isVisible(SensorType /*type*/, u32 attr, std
 		case attributes::temp_input:
 		case attributes::temp_label:
 		case attributes::temp_crit:
-			if (channel > 0 && !(impl_->criticals.tempSupport.test(channel - 1))) {
+			// support is known once the device is initialized
+			if (channel > 0 && initialized() && !(impl_->criticals.tempSupport.test(channel - 1))) {
 				res.set(SensorVisibility::Readable, false);
 			}
 			break;
@@ -150,106 +185,43 @@ wm_sensors::hardware::psu::Corsair::isVisible(SensorType /*type*/, u32 attr, std
 
 int wm_sensors::hardware::psu::Corsair::read(SensorType type, u32 attr, std::size_t channel, double& val) const
 {
-	switch (type) {
-		case SensorType::temp: return checkedReturn(readTemp(attr, channel), val);
-		case SensorType::fan: return checkedReturn(readFan(attr, channel), val);
-		case SensorType::power: return checkedReturn(readPower(attr, channel), val);
-		case SensorType::in: return checkedReturn(readVoltage(attr, channel), val);
-		case SensorType::curr: return checkedReturn(readCurrent(attr, channel), val);
-		case SensorType::duration: return checkedReturn(readDuration(attr, channel), val);
-		default: return -EOPNOTSUPP;
-	}
-}
-
-std::optional<double> wm_sensors::hardware::psu::Corsair::readFan(u32 attr, std::size_t /*channel*/) const
-{
-	if (attr == attributes::fan_input) {
-		return impl_->device.value(corsair::CorsairUSBDevice::Command::FAN_RPM, 0);
+	const int res = impl_->channels.read(type, attr, channel, val);
+	if (res != -EOPNOTSUPP || !impl_->channels.has(type, attr, channel)) {
+		return res;
 	}
-	return {};
-}
 
-std::optional<double> wm_sensors::hardware::psu::Corsair::readTemp(u32 attr, std::size_t channel) const
-{
-	using Command = corsair::CorsairUSBDevice::Command;
-
-	switch (attr) {
-		case attributes::temp_input:
-			return impl_->device.value(channel ? Command::TEMP1 : Command::TEMP0, static_cast<u8>(channel));
-		case attributes::temp_crit: return impl_->criticals.tempMax[channel];
-		default: return {};
+	// the table serves inputs, limits are read here
+	if (!initialized()) {
+		val = std::numeric_limits<double>::quiet_NaN();
+		return 0;
 	}
-}
-
-std::optional<double> wm_sensors::hardware::psu::Corsair::readVoltage(u32 attr, std::size_t channel) const
-{
-	using Command = corsair::CorsairUSBDevice::Command;
-
-	switch (attr) {
-		case attributes::in_input:
-			switch (channel) {
-				case 0: return impl_->device.value(Command::IN_VOLTS, 0);
-				case 1:
-				case 2:
-				case 3: return impl_->device.value(Command::RAIL_VOLTS, static_cast<u8>(channel - 1));
-				default: break;
+	const auto& criticals = impl_->criticals;
+	std::optional<double> v;
+	switch (type) {
+		case SensorType::temp:
+			if (attr == attributes::temp_crit) {
+				v = criticals.tempMax[channel];
 			}
 			break;
-		case attributes::in_crit: return impl_->criticals.voltageMax[channel - 1];
-		case attributes::in_lcrit: return impl_->criticals.voltageMin[channel - 1];
-	}
-
-	return {};
-}
-
-std::optional<double> wm_sensors::hardware::psu::Corsair::readCurrent(u32 attr, std::size_t channel) const
-{
-	using OptionalCommands = corsair::CorsairUSBDevice::OptionalCommands;
-	using Command = corsair::CorsairUSBDevice::Command;
-
-	switch (attr) {
-		case attributes::curr_input:
-			switch (channel) {
-				case 0:
-					if (impl_->optionalCommands & OptionalCommands::InputCurrent)
-						return impl_->device.value(Command::IN_AMPS, 0);
-					else
-						return calcInCurr();
-					break;
-				case 1:
-				case 2:
-				case 3: return impl_->device.value(Command::RAIL_AMPS, static_cast<u8>(channel - 1));
-				default: break;
+		case SensorType::in:
+			if (attr == attributes::in_crit) {
+				v = criticals.voltageMax[channel - 1];
+			} else if (attr == attributes::in_lcrit) {
+				v = criticals.voltageMin[channel - 1];
+			}
+			break;
+		case SensorType::curr:
+			if (attr == attributes::curr_crit) {
+				v = criticals.currentMax[channel - 1];
 			}
 			break;
-		case attributes::curr_crit: return impl_->criticals.currentMax[channel - 1]; break;
 		default: break;
 	}
-
-	return {};
+	return checkedReturn(v, val);
 }
 
-std::optional<double> wm_sensors::hardware::psu::Corsair::readPower(u32 attr, std::size_t channel) const
+const std::atomic<double>*
+wm_sensors::hardware::psu::Corsair::valueSlot(SensorType type, u32 attr, std::size_t channel) const
 {
-	using Command = corsair::CorsairUSBDevice::Command;
-	if (attr == attributes::power_input) {
-		switch (channel) {
-			case 0: return impl_->device.value(Command::TOTAL_WATTS, 0);
-			case 1:
-			case 2:
-			case 3: return impl_->device.value(Command::RAIL_WATTS, static_cast<u8>(channel - 1));
-			default: break;
-		}
-	}
-
-	return {};
-}
-
-std::optional<double> wm_sensors::hardware::psu::Corsair::readDuration(u32 attr, std::size_t channel) const
-{
-	using Command = corsair::CorsairUSBDevice::Command;
-	if (attr == attributes::duration_input) {
-		return impl_->device.value(channel ? Command::TOTAL_UPTIME : Command::UPTIME, 0);
-	}
-	return {};
+	return impl_->channels.valueSlot(type, attr, channel);
 }
@@ -28,18 +28,15 @@ namespace wm_sensors::hardware::psu {
 
 		~Corsair();
 
+	protected:
+		void initialize() const override;
+		void refreshValues() const override;
+		const std::atomic<double>* valueSlot(SensorType type, u32 attr, std::size_t channel) const override;
+
 	private:
 		Corsair(hidapi::device&& dev);
 		DELETE_COPY_CTOR_AND_ASSIGNMENT(Corsair)
 
-
-		std::optional<double> readTemp(u32 attr, std::size_t channel) const;
-		std::optional<double> readFan(u32 attr, std::size_t channel) const;
-		std::optional<double> readPower(u32 attr, std::size_t channel) const;
-		std::optional<double> readCurrent(u32 attr, std::size_t channel) const;
-		std::optional<double> readVoltage(u32 attr, std::size_t channel) const;
-		std::optional<double> readDuration(u32 attr, std::size_t channel) const;
-
 		double calcInCurr() const;
 
 		struct Impl;
@@ -30,6 +30,10 @@ namespace {
 } // namespace
 
 wm_sensors::hardware::psu::corsair::CorsairUSBDevice::CorsairUSBDevice(hidapi::device&& dev) : device_{std::move(dev)}
+{
+}
+
+void wm_sensors::hardware::psu::corsair::CorsairUSBDevice::init()
 {
 	/*
 	 * PSU_CMD_INIT uses swapped length/command and expects 2 parameter bytes, this command
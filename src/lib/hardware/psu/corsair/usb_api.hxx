@@ -18,6 +18,9 @@ namespace wm_sensors::hardware::psu::corsair {
 	public:
 		CorsairUSBDevice(hidapi::device&& dev);
 
+		/** Sends the INIT command, has to precede other commands */
+		void init();
+
 		using Reply = std::array<std::uint8_t, 16>;
 
 		struct FirmwareInfo {
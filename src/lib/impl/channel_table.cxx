@@ -0,0 +1,101 @@
+// SPDX-License-Identifier: LGPL-3.0+
+
+#include "./channel_table.hxx"
+
+#include <cerrno>
+#include <limits>
+
+wm_sensors::impl::ChannelTable::Channel::Channel(u32 attrs, std::string lbl, const double* v, double s, double o)
+    : value{v}
+    , scale{s}
+    , offset{o}
+    , label{std::move(lbl)}
+    , attributes{attrs}
+    , published{v ? s * *v + o : std::numeric_limits<double>::quiet_NaN()}
+{
+}
+
+std::size_t wm_sensors::impl::ChannelTable::add(
+    SensorType type, u32 attributes, std::string label, const double* value, double scale, double offset)
+{
+	auto& channels = channels_.at(utility::to_underlying(type));
+	channels.emplace_back(attributes, std::move(label), value, scale, offset);
+	return channels.size() - 1;
+}
+
+std::size_t wm_sensors::impl::ChannelTable::addChip(u32 attributes, std::chrono::milliseconds updateInterval)
+{
+	updateInterval_ = static_cast<double>(updateInterval.count());
+	return add(SensorType::chip, attributes | attributes::chip_update_interval, {}, &updateInterval_);
+}
+
+void wm_sensors::impl::ChannelTable::publish(const SensorChip::ChannelMask& enabled) const
+{
+	for (std::size_t t = 0; t < channels_.size(); ++t) {
+		const auto type = static_cast<SensorType>(t);
+		for (std::size_t i = 0; i < channels_[t].size(); ++i) {
+			const Channel& c = channels_[t][i];
+			if (!c.value) {
+				continue;
+			}
+			// the chip channel holds a constant, it is not sampled
+			const bool sampled = type == SensorType::chip || enabled.test(type, i);
+			c.published.store(
+			    sampled ? c.scale * *c.value + c.offset : std::numeric_limits<double>::quiet_NaN(),
+			    std::memory_order_relaxed);
+		}
+	}
+}
+
+void wm_sensors::impl::ChannelTable::config(SensorChip::Config& cfg) const
+{
+	for (u8 t = 0; t < sensor_type_max; ++t) {
+		auto& attrs = cfg.sensors[t].channelAttributes;
+		for (const auto& c: channels_[t]) {
+			attrs.push_back(c.attributes);
+		}
+	}
+}
+
+wm_sensors::SensorChip::Config wm_sensors::impl::ChannelTable::config() const
+{
+	SensorChip::Config res;
+	config(res);
+	return res;
+}
+
+int wm_sensors::impl::ChannelTable::read(SensorType type, u32 attr, std::size_t channel, double& val) const
+{
+	const Channel* c = find(type, channel);
+	if (!c) {
+		return -ENOENT;
+	}
+	if (attr != valueAttribute(type) || !c->value || !(c->attributes & attr)) {
+		return -EOPNOTSUPP;
+	}
+	val = c->published.load(std::memory_order_relaxed);
+	return 0;
+}
+
+int wm_sensors::impl::ChannelTable::read(SensorType type, u32 attr, std::size_t channel, std::string_view& str) const
+{
+	const Channel* c = find(type, channel);
+	if (!c) {
+		return -ENOENT;
+	}
+	if (attr != attributes::generic_label || !(c->attributes & attributes::generic_label)) {
+		return -EOPNOTSUPP;
+	}
+	str = c->label;
+	return 0;
+}
+
+const std::atomic<double>*
+wm_sensors::impl::ChannelTable::valueSlot(SensorType type, u32 attr, std::size_t channel) const
+{
+	const Channel* c = find(type, channel);
+	if (!c || !c->value || attr != valueAttribute(type) || !(c->attributes & attr)) {
+		return nullptr;
+	}
+	return &c->published;
+}
@@ -0,0 +1,93 @@
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef WM_SENSORS_LIB_IMPL_CHANNEL_TABLE_HXX
+#define WM_SENSORS_LIB_IMPL_CHANNEL_TABLE_HXX
+
+#include "../sensor.hxx"
+#include "../utility/utility.hxx"
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <string>
+
+namespace wm_sensors::impl {
+	/**
+	 * Declarative description of chip channels.
+	 *
+	 * A driver declares each channel once, with its attributes, label and the cached value it exposes. The table
+	 * then produces the chip config and answers input and label reads by direct indexing, so channel numbering can
+	 * not get out of sync between config() and read().
+	 *
+	 * Value pointers refer to driver-owned storage which is updated in SensorChip::refresh(), hence the storage must
+	 * not be reallocated after the channel was added. publish() copies scale * (*value) + offset into the atomic
+	 * published value each channel owns, which is what readers see. Call it from SensorChip::publish() with the mask
+	 * of channels the refresh sampled.
+	 *
+	 * The value of a chip channel is its update interval (attributes::chip_update_interval), in milliseconds.
+	 */
+	class ChannelTable {
+	public:
+		struct Channel {
+			Channel(u32 attrs, std::string lbl, const double* v, double s, double o);
+
+			const double* value; // nullptr for channels without an input value
+			double scale;
+			double offset;
+			std::string label;
+			u32 attributes;
+			mutable std::atomic<double> published;
+		};
+
+		/** Appends a channel of the given type and returns its index */
+		std::size_t add(SensorType type, u32 attributes, std::string label, const double* value = nullptr,
+		    double scale = 1., double offset = 0.);
+
+		/** Appends the chip channel, which reports @p updateInterval as the minimal useful refresh period */
+		std::size_t addChip(u32 attributes, std::chrono::milliseconds updateInterval);
+
+		std::size_t channelCount(SensorType type) const
+		{
+			return type < SensorType::max ? channels_[utility::to_underlying(type)].size() : 0;
+		}
+
+		/** Returns nullptr if there is no such channel */
+		const Channel* find(SensorType type, std::size_t channel) const
+		{
+			return channel < channelCount(type) ? &channels_[utility::to_underlying(type)][channel] : nullptr;
+		}
+
+		bool has(SensorType type, u32 attr, std::size_t channel) const
+		{
+			const Channel* c = find(type, channel);
+			return c && (c->attributes & attr) == attr;
+		}
+
+		/** Publishes current values of enabled channels, disabled ones read as NaN */
+		void publish(const SensorChip::ChannelMask& enabled) const;
+
+		/** Appends all channels to the config */
+		void config(SensorChip::Config& cfg) const;
+		SensorChip::Config config() const;
+
+		// the functions below return -ENOENT for unknown channels and -EOPNOTSUPP for attributes the table does not
+		// serve (anything except input, label and the chip update interval), letting the driver handle the rest
+		int read(SensorType type, u32 attr, std::size_t channel, double& val) const;
+		int read(SensorType type, u32 attr, std::size_t channel, std::string_view& str) const;
+		/** Returns the published input value location */
+		const std::atomic<double>* valueSlot(SensorType type, u32 attr, std::size_t channel) const;
+
+	private:
+		static u32 valueAttribute(SensorType type)
+		{
+			return type == SensorType::chip ? attributes::chip_update_interval : attributes::generic_input;
+		}
+
+		double updateInterval_ = 0.;
+		// std::deque keeps addresses of the published values stable when channels are appended
+		std::array<std::deque<Channel>, sensor_type_max> channels_;
+	};
+} // namespace wm_sensors::impl
+
+#endif
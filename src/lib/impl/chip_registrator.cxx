@@ -3,10 +3,61 @@
 #include "./chip_registrator.hxx"
 #include "../sensor_tree.hxx"
 
+#include <spdlog/spdlog.h>
+
 #include <algorithm>
+#include <chrono>
+#include <future>
 
 wm_sensors::impl::ChipProbe::~ChipProbe() = default;
 
+bool wm_sensors::impl::ChipProbe::deferrable() const
+{
+	return false;
+}
+
+std::chrono::milliseconds wm_sensors::impl::ChipProbe::deadline() const
+{
+	return std::chrono::seconds(10);
+}
+
+wm_sensors::impl::ProbeRun::ProbeRun(ChipProbe& probe)
+    : probe_{probe}
+    , tree_{std::make_unique<SensorChipTreeNode>(nullptr)}
+    , started_{Clock::now()}
+    , duration_{}
+{
+	found_ = std::async(std::launch::async, [this] {
+		const bool res = probe_.probe(*tree_);
+		duration_ = Clock::now() - started_;
+		return res;
+	});
+}
+
+wm_sensors::impl::ProbeRun::~ProbeRun()
+{
+	if (found_.valid()) {
+		found_.wait();
+	}
+}
+
+bool wm_sensors::impl::ProbeRun::waitUntil(Clock::time_point time) const
+{
+	return found_.wait_until(time) == std::future_status::ready;
+}
+
+wm_sensors::ProbeTiming wm_sensors::impl::ProbeRun::finish(SensorChipTreeNode* tree)
+{
+	const bool found = found_.get();
+	if (tree) {
+		tree->merge(std::move(*tree_));
+	}
+	ProbeTiming res{std::string(probe_.name()), std::chrono::duration_cast<std::chrono::microseconds>(duration_),
+	    found, false};
+	spdlog::debug("Probe '{}' took {} us, found: {}", res.probe, res.duration.count(), found);
+	return res;
+}
+
 wm_sensors::impl::PersistentHardwareRegistratorImpl::PersistentHardwareRegistratorImpl(std::unique_ptr<ChipProbe> probe)
     : probe_{probe.get()}
 {
@@ -41,9 +92,43 @@ void wm_sensors::impl::ChipProbesRegistry::remove(ChipProbe* probe)
 		return p.get() == probe; });
 }
 
-void wm_sensors::impl::ChipProbesRegistry::probeAll(SensorChipTreeNode& tree)
+std::vector<std::string_view> wm_sensors::impl::ChipProbesRegistry::names() const
+{
+	std::vector<std::string_view> res;
+	res.reserve(probes_.size());
+	for (const auto& probe: probes_) {
+		res.push_back(probe->name());
+	}
+	return res;
+}
+
+std::vector<wm_sensors::ProbeTiming>
+wm_sensors::impl::ChipProbesRegistry::probeAll(SensorChipTreeNode& tree, const Filter& selected)
+{
+	std::vector<std::unique_ptr<ProbeRun>> runs;
+	runs.reserve(probes_.size());
+	for (const auto& probe: probes_) {
+		if (!selected || selected(*probe)) {
+			runs.push_back(std::make_unique<ProbeRun>(*probe));
+		}
+	}
+
+	// a probe exception propagates once the remaining runs complete, see ~ProbeRun()
+	std::vector<ProbeTiming> res;
+	res.reserve(runs.size());
+	for (const auto& r: runs) {
+		res.push_back(r->finish(&tree));
+	}
+	return res;
+}
+
+std::vector<std::unique_ptr<wm_sensors::impl::ProbeRun>> wm_sensors::impl::ChipProbesRegistry::start(bool deferrable, const Filter& selected)
 {
-	for (const auto& probe : probes_) {
-		probe->probe(tree);
+	std::vector<std::unique_ptr<ProbeRun>> res;
+	for (const auto& probe: probes_) {
+		if (probe->deferrable() == deferrable && (!selected || selected(*probe))) {
+			res.push_back(std::make_unique<ProbeRun>(*probe));
+		}
 	}
+	return res;
 }
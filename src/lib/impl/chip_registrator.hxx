@@ -5,13 +5,19 @@
 
 #include "../source_class.hxx"
 #include "../sensor.hxx"
+#include "../utility/macro.hxx"
 
+#include <chrono>
+#include <functional>
+#include <future>
 #include <memory>
+#include <string_view>
 #include <vector>
 
 namespace wm_sensors {
 	template <class, class>
 	class SensorTreeNode;
+	struct ProbeTiming;
 
 	using SensorChipTreeNode = SensorTreeNode<HardwareType, std::unique_ptr<SensorChip>>;
 }
@@ -22,7 +28,59 @@ namespace wm_sensors::impl {
 	public:
 		virtual ~ChipProbe();
 
+		/**
+		 * Adds detected chips to the tree. Probes run concurrently, each one with its own tree, which is merged into
+		 * the resulting one afterwards.
+		 */
 		virtual bool probe(SensorChipTreeNode& sensorsTree) = 0;
+		/** Reported in probe timings */
+		virtual std::string_view name() const = 0;
+
+		/** Whether chips of the probe may be attached after the tree was returned (progressive construction) */
+		virtual bool deferrable() const;
+		/**
+		 * Chips of deferred probes which do not complete in time are dropped. The probe keeps running though, it
+		 * can not be cancelled, and destruction of its ProbeRun (with the tree) waits for it to return.
+		 */
+		virtual std::chrono::milliseconds deadline() const;
+	};
+
+	/** Probe running asynchronously, which fills its own tree */
+	class ProbeRun {
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		explicit ProbeRun(ChipProbe& probe);
+		/** Waits for the probe, which uses the run object */
+		~ProbeRun();
+
+		const ChipProbe& probe() const
+		{
+			return probe_;
+		}
+
+		Clock::time_point started() const
+		{
+			return started_;
+		}
+
+		/** Returns true if the probe completed */
+		bool waitUntil(Clock::time_point time) const;
+
+		/**
+		 * Waits for the probe and returns its timing, moving the found chips into @p tree unless it is nullptr.
+		 * Rethrows exception of the probe.
+		 */
+		ProbeTiming finish(SensorChipTreeNode* tree);
+
+	private:
+		DELETE_COPY_CTOR_AND_ASSIGNMENT(ProbeRun)
+
+		ChipProbe& probe_;
+		std::unique_ptr<SensorChipTreeNode> tree_;
+		Clock::time_point started_;
+		Clock::duration duration_;
+		std::future<bool> found_;
 	};
 
 	class PersistentHardwareRegistratorImpl {
@@ -49,10 +107,20 @@ namespace wm_sensors::impl {
 
 		~ChipProbesRegistry();
 
+		/** Selects probes to run, all of them are run if empty */
+		using Filter = std::function<bool(const ChipProbe& probe)>;
+
 		void add(std::unique_ptr<ChipProbe> probe);
 		void remove(ChipProbe* probe);
 
-		void probeAll(SensorChipTreeNode& tree);
+		/** Names of the registered probes */
+		std::vector<std::string_view> names() const;
+
+		/** Runs probes concurrently and merges their results into the tree in the registration order */
+		std::vector<ProbeTiming> probeAll(SensorChipTreeNode& tree, const Filter& selected = {});
+
+		/** Starts probes which are deferrable() or not */
+		std::vector<std::unique_ptr<ProbeRun>> start(bool deferrable, const Filter& selected = {});
 
 	private:
 		ChipProbesRegistry();
@@ -11,9 +11,13 @@
 #include <limits>
 
 wm_sensors::impl::ThreadGroupAffinityGuard::ThreadGroupAffinityGuard(GroupAffinity a)
-    : previous_{GroupAffinity::set(a)}
-    , set_{true}
+    : previous_{GroupAffinity::current()}
+    , set_{!(previous_ == a)}
 {
+	// querying the affinity is cheaper than setting it, which may reschedule the thread
+	if (set_) {
+		GroupAffinity::set(a);
+	}
 }
 
 wm_sensors::impl::ThreadGroupAffinityGuard::~ThreadGroupAffinityGuard()
@@ -57,6 +61,15 @@ wm_sensors::impl::GroupAffinity wm_sensors::impl::GroupAffinity::set(GroupAffini
 	return GroupAffinity(prev.Group, prev.Mask);
 }
 
+wm_sensors::impl::GroupAffinity wm_sensors::impl::GroupAffinity::current()
+{
+	GROUP_AFFINITY a{0};
+	if (!::GetThreadGroupAffinity(::GetCurrentThread(), &a)) {
+		spdlog::error(windowsLastErrorMessage());
+	}
+	return GroupAffinity(a.Group, a.Mask);
+}
+
 unsigned short wm_sensors::impl::processorGroupCount()
 {
 	return ::GetActiveProcessorGroupCount();
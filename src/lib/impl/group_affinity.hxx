@@ -12,8 +12,16 @@ namespace wm_sensors::impl {
 
 		GroupAffinity(unsigned short group, unsigned long long mask);
 
+		/** Sets affinity of the calling thread, returns the previous one */
 		static GroupAffinity set(GroupAffinity affinity);
-		
+		/** Affinity of the calling thread */
+		static GroupAffinity current();
+
+		bool operator==(const GroupAffinity& other) const
+		{
+			return group_ == other.group_ && mask_ == other.mask_;
+		}
+
 		unsigned short group() const
 		{
 			return group_;
@@ -30,6 +38,7 @@ namespace wm_sensors::impl {
 	};
 
 
+	/** Moves the calling thread to the affinity for its lifetime, does nothing if the thread is there already */
 	class ThreadGroupAffinityGuard {
 	public:
 		ThreadGroupAffinityGuard(GroupAffinity a);
@@ -243,25 +243,27 @@ namespace {
 
 wm_sensors::impl::libsensors::ChipData::ChipData(const SensorChip* chip)
     : chip_{chip}
-    , config_{chip->config()}
+    , config_{*chip->cachedConfig()}
 {
-	for (const auto& s: config_.sensors) {
-		const auto channelCount = s.second.channelAttributes.size();
+	for (u8 t = 0; t < sensor_type_max; ++t) {
+		const auto type = static_cast<SensorType>(t);
+		const auto& channelAttributes = config_.sensors[t].channelAttributes;
+		const auto channelCount = channelAttributes.size();
 		std::vector<std::pair<u32, sensors_subfeature_type>> subfeatures;
 		for (std::size_t i = 0; i < channelCount; ++i) {
 			sensors_feature f;
-			f.name = strndup(fmt::format("{0}{1}", s.first, i));
+			f.name = strndup(fmt::format("{0}{1}", type, i));
 			f.number = static_cast<int>(features_.size());
-			f.type = sensorTypeToFeatureType(s.first);
+			f.type = sensorTypeToFeatureType(type);
 			f.first_subfeature = static_cast<int>(subfeatures_.size());
 			f.padding1 =static_cast<int>(i);
 			features_.push_back(std::move(f));
-			featureChannels_.push_back({s.first, i});
+			featureChannels_.push_back({type, i});
 
-			expandAttributes(s.first, s.second.channelAttributes[i], subfeatures);
+			expandAttributes(type, channelAttributes[i], subfeatures);
 			for (auto sft: subfeatures) {
 				sensors_subfeature sf;
-				auto vis = chip->isVisible(s.first, sft.first, i);
+				auto vis = chip->isVisible(type, sft.first, i);
 				sf.flags = 0;
 				if (vis.test(SensorVisibility::Readable)) {
 					sf.flags |= SENSORS_MODE_R;
@@ -294,6 +296,12 @@ char* wm_sensors::impl::libsensors::ChipData::label(const sensors_feature* featu
 
 int wm_sensors::impl::libsensors::ChipData::read(std::size_t subfeatureNr, double& value) const
 {
+	const auto now = std::chrono::steady_clock::now();
+	if (now - lastRefresh_ >= refreshInterval) {
+		chip().refresh();
+		lastRefresh_ = now;
+	}
+
 	const sensors_subfeature& sf = subfeatures_[subfeatureNr];
 	const sensors_feature& f = features_[utility::to_unsigned_checked(sf.mapping)];
 	return chip().read(featureTypeToSensorType(f.type), 1u << subfeatureAttributes_[subfeatureNr], utility::to_unsigned_checked(f.padding1), value);
@@ -6,6 +6,8 @@
 #include "../../sensor.hxx" // wm_sensors sensor API
 #include "../../sensors.h" // libsensors API
 
+#include <chrono>
+
 namespace wm_sensors::impl::libsensors {
 	class ChipData {
 	public:
@@ -15,6 +17,9 @@ namespace wm_sensors::impl::libsensors {
 		ChipData(ChipData&&) noexcept = default;
 		ChipData& operator=(ChipData&&) = default;
 
+		/** libsensors has no notion of an update cycle, hence the chip is refreshed when its values get stale */
+		static constexpr const std::chrono::seconds refreshInterval{1};
+
 		const SensorChip& chip() const
 		{
 			return *chip_;
@@ -56,6 +61,7 @@ namespace wm_sensors::impl::libsensors {
 		std::vector<std::pair<SensorType, std::size_t>> featureChannels_;
 		std::vector<sensors_subfeature> subfeatures_;
 		std::vector<u32> subfeatureAttributes_;
+		mutable std::chrono::steady_clock::time_point lastRefresh_;
 	};
 } // namespace wm_sensors::impl::libsensors
 
@@ -0,0 +1,219 @@
+// SPDX-License-Identifier: LGPL-3.0+
+
+#include "./refresh_executor.hxx"
+
+#include <spdlog/spdlog.h>
+
+#include <algorithm>
+#include <exception>
+#include <latch>
+#include <numeric>
+
+namespace {
+	bool sharesHardware(const wm_sensors::SensorChip::RefreshDomain& a, const wm_sensors::SensorChip::RefreshDomain& b)
+	{
+		using wm_sensors::BusType;
+		const bool sharedBus = a.bus != BusType::Any && a.bus != BusType::Virtual && a.bus == b.bus;
+		return sharedBus || (a.systemLocks & b.systemLocks) != 0;
+	}
+
+	void refreshChip(const wm_sensors::SensorChip& chip, const wm_sensors::impl::RefreshExecutor::Callback& done)
+	{
+		try {
+			chip.refresh();
+		} catch (const std::exception& e) {
+			spdlog::error("Refreshing chip '{}' failed: {}", chip.identifier().name, e.what());
+		}
+		if (done) {
+			done(chip);
+		}
+	}
+} // namespace
+
+wm_sensors::impl::RefreshExecutor::RefreshExecutor(std::size_t threads)
+    : shutdown_{false}
+{
+	threads_.reserve(threads);
+	for (std::size_t i = 0; i < threads; ++i) {
+		threads_.emplace_back([this] { worker(); });
+	}
+}
+
+wm_sensors::impl::RefreshExecutor::~RefreshExecutor()
+{
+	{
+		std::lock_guard<std::mutex> lock{mutex_};
+		shutdown_ = true;
+	}
+	tasksAvailable_.notify_all();
+	for (auto& t: threads_) {
+		t.join();
+	}
+}
+
+std::size_t wm_sensors::impl::RefreshExecutor::defaultThreadCount()
+{
+	// there are only a few independent buses
+	return std::clamp<std::size_t>(std::thread::hardware_concurrency(), 1, 4) - 1;
+}
+
+std::vector<wm_sensors::impl::RefreshExecutor::Chips>
+wm_sensors::impl::RefreshExecutor::group(const Chips& chips)
+{
+	std::vector<SensorChip::RefreshDomain> domains;
+	domains.reserve(chips.size());
+	for (const SensorChip* chip: chips) {
+		domains.push_back(chip->refreshDomain());
+	}
+
+	// union-find over chips, two chips are joined if they share hardware
+	std::vector<std::size_t> parent(chips.size());
+	std::iota(parent.begin(), parent.end(), std::size_t{0});
+	const auto root = [&](std::size_t i) {
+		while (parent[i] != i) {
+			i = parent[i] = parent[parent[i]];
+		}
+		return i;
+	};
+	for (std::size_t i = 0; i < chips.size(); ++i) {
+		for (std::size_t j = i + 1; j < chips.size(); ++j) {
+			if (sharesHardware(domains[i], domains[j])) {
+				parent[root(j)] = root(i);
+			}
+		}
+	}
+
+	std::vector<Chips> res;
+	std::vector<std::size_t> groupIndex(chips.size(), chips.size());
+	for (std::size_t i = 0; i < chips.size(); ++i) {
+		std::size_t& gi = groupIndex[root(i)];
+		if (gi == chips.size()) {
+			gi = res.size();
+			res.emplace_back();
+		}
+		res[gi].push_back(chips[i]);
+	}
+	return res;
+}
+
+void wm_sensors::impl::RefreshExecutor::refresh(const Chips& chips, const Callback& done)
+{
+	refreshGroups(group(chips), done);
+}
+
+void wm_sensors::impl::RefreshExecutor::refreshGroups(const std::vector<Chips>& groups, const Callback& done)
+{
+	if (groups.empty()) {
+		return;
+	}
+
+	const auto refreshGroup = [&done](const Chips& g) {
+		for (const SensorChip* chip: g) {
+			refreshChip(*chip, done);
+		}
+	};
+
+	std::latch pending{static_cast<std::ptrdiff_t>(groups.size())};
+	bool pooled;
+	{
+		// refreshGroupsTogether() may grow the pool concurrently
+		std::lock_guard<std::mutex> lock{mutex_};
+		pooled = !threads_.empty();
+		for (std::size_t i = 1; pooled && i < groups.size(); ++i) {
+			tasks_.push_back([&, i] {
+				refreshGroup(groups[i]);
+				pending.count_down();
+			});
+		}
+	}
+	if (pooled) {
+		tasksAvailable_.notify_all();
+		refreshGroup(groups[0]);
+		pending.count_down();
+		// help with the queued groups instead of idling
+		while (runQueuedTask()) {
+		}
+	} else {
+		for (const auto& g: groups) {
+			refreshGroup(g);
+			pending.count_down();
+		}
+	}
+	pending.wait();
+}
+
+void wm_sensors::impl::RefreshExecutor::refreshTogether(const Chips& chips, const Callback& done)
+{
+	refreshGroupsTogether(group(chips), done);
+}
+
+void wm_sensors::impl::RefreshExecutor::refreshGroupsTogether(const std::vector<Chips>& groups, const Callback& done)
+{
+	if (groups.empty()) {
+		return;
+	}
+
+	// tasks of two sweeps could occupy all pool threads, each of them waiting for the other sweep's threads
+	std::lock_guard<std::mutex> togetherLock{togetherMutex_};
+
+	// a pool thread running a group blocks until all of them start, so every group needs a thread
+	{
+		std::lock_guard<std::mutex> lock{mutex_};
+		while (threads_.size() + 1 < groups.size()) {
+			threads_.emplace_back([this] { worker(); });
+		}
+	}
+
+	const auto refreshGroup = [&done](const Chips& g) {
+		for (const SensorChip* chip: g) {
+			refreshChip(*chip, done);
+		}
+	};
+
+	std::latch ready{static_cast<std::ptrdiff_t>(groups.size())};
+	std::latch pending{static_cast<std::ptrdiff_t>(groups.size())};
+	{
+		std::lock_guard<std::mutex> lock{mutex_};
+		for (std::size_t i = 1; i < groups.size(); ++i) {
+			tasks_.push_back([&, i] {
+				ready.arrive_and_wait();
+				refreshGroup(groups[i]);
+				pending.count_down();
+			});
+		}
+	}
+	tasksAvailable_.notify_all();
+	ready.arrive_and_wait();
+	refreshGroup(groups[0]);
+	pending.count_down();
+	pending.wait();
+}
+
+bool wm_sensors::impl::RefreshExecutor::runQueuedTask()
+{
+	std::function<void()> task;
+	{
+		std::lock_guard<std::mutex> lock{mutex_};
+		if (tasks_.empty()) {
+			return false;
+		}
+		task = std::move(tasks_.front());
+		tasks_.pop_front();
+	}
+	task();
+	return true;
+}
+
+void wm_sensors::impl::RefreshExecutor::worker()
+{
+	for (;;) {
+		{
+			std::unique_lock<std::mutex> lock{mutex_};
+			tasksAvailable_.wait(lock, [this] { return shutdown_ || !tasks_.empty(); });
+			if (tasks_.empty()) {
+				return;
+			}
+		}
+		runQueuedTask();
+	}
+}
@@ -0,0 +1,69 @@
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef WM_SENSORS_LIB_IMPL_REFRESH_EXECUTOR_HXX
+#define WM_SENSORS_LIB_IMPL_REFRESH_EXECUTOR_HXX
+
+#include "../sensor.hxx"
+#include "../utility/macro.hxx"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace wm_sensors::impl {
+	/**
+	 * Refreshes sets of chips on a small thread pool.
+	 *
+	 * Chips are split into groups by SensorChip::refreshDomain(): chips sharing a bus or a system lock end up in the
+	 * same group and are refreshed one after another, independent groups run concurrently. Thus a slow transaction on
+	 * one bus does not delay chips on other ones.
+	 */
+	class RefreshExecutor {
+	public:
+		using Chips = std::vector<const SensorChip*>;
+		using Callback = std::function<void(const SensorChip& chip)>;
+
+		/** @p threads is the number of pool threads, the calling thread of refresh() is used too */
+		explicit RefreshExecutor(std::size_t threads = defaultThreadCount());
+		~RefreshExecutor();
+
+		/**
+		 * Refreshes all chips and returns when they are done. @p done is invoked after each chip is refreshed, from
+		 * the thread which refreshed it.
+		 */
+		void refresh(const Chips& chips, const Callback& done = {});
+		/** Same for chips already split by group(), lets callers refreshing the same chips repeatedly reuse them */
+		void refreshGroups(const std::vector<Chips>& groups, const Callback& done = {});
+
+		/**
+		 * Like refresh(), but starts all groups at once: each group gets its own thread, the pool grows if needed,
+		 * and the threads wait for each other before they refresh their first chips. Concurrent calls run one after
+		 * another, their threads would wait for each other otherwise.
+		 */
+		void refreshTogether(const Chips& chips, const Callback& done = {});
+		void refreshGroupsTogether(const std::vector<Chips>& groups, const Callback& done = {});
+
+		/** Splits chips into groups which can be refreshed concurrently, preserving their order within a group */
+		static std::vector<Chips> group(const Chips& chips);
+
+		static std::size_t defaultThreadCount();
+
+	private:
+		DELETE_COPY_CTOR_AND_ASSIGNMENT(RefreshExecutor)
+
+		bool runQueuedTask();
+		void worker();
+
+		std::vector<std::thread> threads_;
+		std::deque<std::function<void()>> tasks_;
+		std::mutex mutex_;         // guards threads_, tasks_ and shutdown_
+		std::mutex togetherMutex_; // held for the whole refreshGroupsTogether() call
+		std::condition_variable tasksAvailable_;
+		bool shutdown_;
+	};
+} // namespace wm_sensors::impl
+
+#endif
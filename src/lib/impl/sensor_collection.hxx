@@ -4,39 +4,74 @@
 #define WM_SENSORS_LIB_IMPL_SENSOR_COLLECTION_HXX
 
 #include "../sensor.hxx"
+#include "../utility/utility.hxx"
 
 #include <algorithm>
+#include <atomic>
 #include <concepts>
+#include <deque>
 #include <limits>
+#include <map>
 #include <memory>
 #include <stdexcept>
 
 namespace wm_sensors::impl {
+	/** Sensor value is written by the chip refresh and becomes visible to readers with publish() */
 	class Sensor {
 	public:
 		Sensor(std::string label)
 		    : value_{std::numeric_limits<double>::quiet_NaN()}
+		    , published_{std::numeric_limits<double>::quiet_NaN()}
 		    , label_{std::move(label)}
 		{
 		}
 
+		Sensor(Sensor&& other) noexcept
+		    : value_{other.value_}
+		    , published_{other.published_.load(std::memory_order_relaxed)}
+		    , label_{std::move(other.label_)}
+		{
+		}
+
 		double value() const
 		{
 			return value_;
 		}
 
+		double publishedValue() const
+		{
+			return published_.load(std::memory_order_relaxed);
+		}
+
+		const std::atomic<double>* valueSlot() const
+		{
+			return &published_;
+		}
+
 		void value(double v)
 		{
 			value_ = v;
 		}
 
+		void publish()
+		{
+			published_.store(value_, std::memory_order_relaxed);
+		}
+
+		/** Publishes NaN for a disabled sensor, the working value is kept for sensors derived from it */
+		void publishDisabled()
+		{
+			published_.store(std::numeric_limits<double>::quiet_NaN(), std::memory_order_relaxed);
+		}
+
 		const std::string& label() const
 		{
 			return label_;
 		}
 
 	private:
-		mutable double value_;
+		double value_;
+		std::atomic<double> published_;
 		std::string label_;
 	};
 
@@ -68,6 +103,8 @@ namespace wm_sensors::impl {
 				return type != SensorType::max;
 			}
 
+			bool operator==(const Handle&) const noexcept = default;
+
 		private:
 			Handle(std::size_t ind, SensorType t) noexcept
 			    : index{ind}
@@ -138,6 +175,49 @@ namespace wm_sensors::impl {
 			setSensorActive(sensor, false);
 		}
 
+		/** Chip channel number of the sensor */
+		std::size_t channel(Handle handle) const
+		{
+			return baseCounts_[utility::to_underlying(handle.type)] + handle.index;
+		}
+
+		/** Sensor of the chip channel, a null handle if the channel does not belong to the collection */
+		Handle handle(SensorType type, std::size_t channel) const
+		{
+			std::size_t myChannel;
+			if (SensorChip::Config::isInRange(baseCounts_, type, channel, &myChannel)) {
+				const auto it = sensors_.find(type);
+				if (it != sensors_.end() && myChannel < it->second.size()) {
+					return {myChannel, type};
+				}
+			}
+			return {};
+		}
+
+		bool enabled(const SensorChip::ChannelMask& mask, Handle handle) const
+		{
+			return handle && mask.test(handle.type, channel(handle));
+		}
+
+		/**
+		 * Publishes values of all sensors, call from SensorChip::publish(). Sensors disabled in @p enabled publish
+		 * NaN.
+		 */
+		void publish(const SensorChip::ChannelMask& enabled)
+		{
+			for (auto& ts: sensors_) {
+				const std::size_t base = baseCounts_[utility::to_underlying(ts.first)];
+				for (std::size_t i = 0; i < ts.second.size(); ++i) {
+					Sensor& s = ts.second[i].sensor;
+					if (enabled.test(ts.first, base + i)) {
+						s.publish();
+					} else {
+						s.publishDisabled();
+					}
+				}
+			}
+		}
+
 		SensorChip::Config::ChannelCounts config(SensorChip::Config& cfg) const
 		{
 			auto res = cfg.nrChannels();
@@ -161,13 +241,27 @@ namespace wm_sensors::impl {
 				const auto it = sensors_.find(type);
 				if (it != sensors_.end() && myChannel < it->second.size()) {
 					switch (attr) {
-						case attributes::generic_input: val = it->second[myChannel].sensor.value(); return 0;
+						case attributes::generic_input: val = it->second[myChannel].sensor.publishedValue(); return 0;
 					}
 				}
 			}
 			return -EOPNOTSUPP;
 		}
 
+		const std::atomic<double>* valueSlot(SensorType type, u32 attr, std::size_t channel) const
+		{
+			std::size_t myChannel;
+
+			if (attr == attributes::generic_input &&
+			    SensorChip::Config::isInRange(baseCounts_, type, channel, &myChannel)) {
+				const auto it = sensors_.find(type);
+				if (it != sensors_.end() && myChannel < it->second.size()) {
+					return it->second[myChannel].sensor.valueSlot();
+				}
+			}
+			return nullptr;
+		}
+
 		int read(SensorType type, u32 attr, std::size_t channel, std::string_view& str) const
 		{
 			std::size_t myChannel;
@@ -196,7 +290,8 @@ namespace wm_sensors::impl {
 		};
 
 		SensorChip::Config::ChannelCounts baseCounts_;
-		std::map<SensorType, std::vector<SensorInfo>> sensors_;
+		// std::deque keeps value slots in place when sensors are added
+		std::map<SensorType, std::deque<SensorInfo>> sensors_;
 	};
 } // namespace wm_sensors::impl
 
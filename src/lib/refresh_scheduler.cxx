@@ -0,0 +1,201 @@
+// SPDX-License-Identifier: LGPL-3.0+
+
+#include "./refresh_scheduler.hxx"
+
+#include "./impl/refresh_executor.hxx"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace {
+	// wheel resolution and size, one revolution spans a bit more than 5 s
+	constexpr const std::chrono::milliseconds tickDuration{10};
+	constexpr const std::size_t wheelSize = 512;
+} // namespace
+
+struct wm_sensors::RefreshScheduler::Impl {
+	Impl(RefreshScheduler& owner, std::chrono::milliseconds defaultInterval);
+	~Impl();
+
+	DELETE_COPY_CTOR_AND_ASSIGNMENT(Impl)
+
+	// every entry is referenced once, by a wheel slot or by the due list of run()
+	struct Entry {
+		const SensorChip* chip; // nullptr once removed
+		u64 intervalTicks;
+		u64 dueTick;
+	};
+
+	u64 currentTick() const;
+	void schedule(std::size_t entryIndex);
+	void run();
+
+	RefreshScheduler& owner;
+	std::chrono::milliseconds defaultInterval;
+	Clock::time_point start;
+	std::vector<Entry> entries;
+	std::array<std::vector<std::size_t>, wheelSize> wheel; // indices into entries
+	std::vector<std::size_t> freeEntries; // removed entries run() dropped from the wheel, reused by add()
+	u64 processedTick;
+	std::mutex mutex;        // guards the above
+	std::mutex refreshMutex; // held while chips are refreshed, lets remove() wait for them
+	std::condition_variable wakeUp;
+	bool shutdown;
+	impl::RefreshExecutor executor;
+	std::thread thread;
+};
+
+wm_sensors::RefreshScheduler::Impl::Impl(RefreshScheduler& o, std::chrono::milliseconds interval)
+    : owner{o}
+    , defaultInterval{interval}
+    , start{Clock::now()}
+    , processedTick{0}
+    , shutdown{false}
+{
+	thread = std::thread([this] { run(); });
+}
+
+wm_sensors::RefreshScheduler::Impl::~Impl()
+{
+	{
+		std::lock_guard<std::mutex> lock{mutex};
+		shutdown = true;
+	}
+	wakeUp.notify_one();
+	thread.join();
+}
+
+wm_sensors::u64 wm_sensors::RefreshScheduler::Impl::currentTick() const
+{
+	return static_cast<u64>((Clock::now() - start) / tickDuration);
+}
+
+void wm_sensors::RefreshScheduler::Impl::schedule(std::size_t entryIndex)
+{
+	wheel[entries[entryIndex].dueTick % wheelSize].push_back(entryIndex);
+}
+
+void wm_sensors::RefreshScheduler::Impl::run()
+{
+	std::vector<std::size_t> due;
+	std::unique_lock<std::mutex> lock{mutex};
+	while (!shutdown) {
+		// collect entries which are due from the slots passed since the last round, visiting each slot once at most
+		const u64 now = currentTick();
+		const u64 last = std::min(now, processedTick + wheelSize - 1);
+		for (u64 tick = processedTick; tick <= last; ++tick) {
+			auto& slot = wheel[tick % wheelSize];
+			const auto dueEnd = std::partition(slot.begin(), slot.end(), [&](std::size_t i) {
+				return entries[i].chip && entries[i].dueTick > now;
+			});
+			for (auto it = dueEnd; it != slot.end(); ++it) {
+				if (entries[*it].chip) {
+					due.push_back(*it);
+				} else {
+					freeEntries.push_back(*it);
+				}
+			}
+			slot.erase(dueEnd, slot.end());
+		}
+		processedTick = now + 1;
+
+		if (!due.empty()) {
+			lock.unlock();
+			{
+				std::lock_guard<std::mutex> refreshLock{refreshMutex};
+				impl::RefreshExecutor::Chips chips;
+				{
+					std::lock_guard<std::mutex> entriesLock{mutex};
+					for (std::size_t i: due) {
+						if (entries[i].chip) {
+							chips.push_back(entries[i].chip);
+						}
+					}
+				}
+				executor.refresh(chips, [this](const SensorChip& chip) { owner.chipRefreshed(chip); });
+			}
+			lock.lock();
+
+			// next deadline keeps the phase, deadlines missed because of slow refreshes are skipped
+			const u64 after = currentTick();
+			for (std::size_t i: due) {
+				Entry& e = entries[i];
+				if (!e.chip) {
+					freeEntries.push_back(i);
+					continue;
+				}
+				e.dueTick += e.intervalTicks;
+				if (e.dueTick <= after) {
+					e.dueTick += ((after - e.dueTick) / e.intervalTicks + 1) * e.intervalTicks;
+				}
+				schedule(i);
+			}
+			due.clear();
+			continue;
+		}
+
+		// sleep until the nearest non-empty slot, which may hold entries for one of the next revolutions only
+		u64 next = processedTick + wheelSize;
+		for (u64 tick = processedTick; tick < processedTick + wheelSize; ++tick) {
+			if (!wheel[tick % wheelSize].empty()) {
+				next = tick;
+				break;
+			}
+		}
+		wakeUp.wait_until(lock, start + next * tickDuration);
+	}
+}
+
+wm_sensors::RefreshScheduler::RefreshScheduler(std::chrono::milliseconds defaultInterval)
+    : impl_{std::make_unique<Impl>(*this, defaultInterval)}
+{
+}
+
+wm_sensors::RefreshScheduler::~RefreshScheduler() = default;
+
+void wm_sensors::RefreshScheduler::add(const SensorChip& chip)
+{
+	const auto interval = std::max(updateInterval(chip, impl_->defaultInterval), tickDuration);
+	{
+		std::lock_guard<std::mutex> lock{impl_->mutex};
+		const Impl::Entry entry{
+		    &chip, static_cast<u64>(interval / tickDuration), std::max(impl_->currentTick(), impl_->processedTick)};
+		std::size_t index;
+		if (impl_->freeEntries.empty()) {
+			index = impl_->entries.size();
+			impl_->entries.push_back(entry);
+		} else {
+			index = impl_->freeEntries.back();
+			impl_->freeEntries.pop_back();
+			impl_->entries[index] = entry;
+		}
+		impl_->schedule(index);
+	}
+	impl_->wakeUp.notify_one();
+}
+
+void wm_sensors::RefreshScheduler::remove(const SensorChip& chip)
+{
+	std::lock_guard<std::mutex> refreshLock{impl_->refreshMutex};
+	std::lock_guard<std::mutex> lock{impl_->mutex};
+	for (auto& e: impl_->entries) {
+		if (e.chip == &chip) {
+			e.chip = nullptr;
+		}
+	}
+}
+
+std::chrono::milliseconds
+wm_sensors::RefreshScheduler::updateInterval(const SensorChip& chip, std::chrono::milliseconds fallback)
+{
+	double val;
+	if (chip.read(SensorType::chip, attributes::chip_update_interval, 0, val) == 0 && std::isfinite(val) && val > 0.) {
+		return std::chrono::milliseconds(static_cast<std::chrono::milliseconds::rep>(val));
+	}
+	return fallback;
+}
@@ -0,0 +1,55 @@
+// SPDX-License-Identifier: LGPL-3.0+
+#ifndef WM_SENSORS_LIB_REFRESH_SCHEDULER_HXX
+#define WM_SENSORS_LIB_REFRESH_SCHEDULER_HXX
+
+#include "./sensor.hxx"
+#include "./utility/macro.hxx"
+
+#include <sigslot/signal.hpp>
+
+#include <chrono>
+#include <memory>
+
+#include "wm-sensors_export.h"
+
+namespace wm_sensors {
+	/**
+	 * Refreshes chips in the background, each one at its own pace.
+	 *
+	 * The period of a chip is read from its chip_update_interval attribute (milliseconds, as in hwmon). Chips that do
+	 * not provide the attribute are refreshed at the default interval. Deadlines are kept in a hashed timer wheel, the
+	 * scheduler thread sleeps until the nearest one and refreshes every chip that is due, concurrently for chips on
+	 * independent buses. chipRefreshed is emitted after each refresh from the thread which refreshed the chip.
+	 */
+	class WM_SENSORS_EXPORT RefreshScheduler {
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		explicit RefreshScheduler(std::chrono::milliseconds defaultInterval = std::chrono::seconds(1));
+		~RefreshScheduler();
+
+		/**
+		 * Adds the chip, which is refreshed immediately and then periodically.
+		 * The chip has to outlive the scheduler or be removed from it.
+		 */
+		void add(const SensorChip& chip);
+		/**
+		 * Removes the chip, waits for its refresh to complete if one is running. Must not be called from
+		 * chipRefreshed.
+		 */
+		void remove(const SensorChip& chip);
+
+		/** Returns the chip_update_interval value of the chip or @p fallback if the chip does not provide it */
+		static std::chrono::milliseconds updateInterval(const SensorChip& chip, std::chrono::milliseconds fallback);
+
+		sigslot::signal<void(const SensorChip& chip)> chipRefreshed;
+
+	private:
+		DELETE_COPY_CTOR_AND_ASSIGNMENT(RefreshScheduler)
+
+		struct Impl;
+		std::unique_ptr<Impl> impl_;
+	};
+} // namespace wm_sensors
+
+#endif
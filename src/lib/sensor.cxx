@@ -4,6 +4,8 @@
 
 #include "./utility/utility.hxx"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <stdexcept>
 #include <utility>
@@ -45,7 +47,15 @@ namespace {
 
 wm_sensors::SensorChip::SensorChip(Identifier id)
     : identifier_{std::move(id)}
+    , configEpoch_{0}
+    , acquired_{0}
+    , sequence_{0}
+    , refreshStarted_{0}
+    , initialized_{false}
+    , enabled_{std::make_shared<ChannelMask>()}
 {
+	sensorAdded.connect([this](const SensorChip&, SensorType) { invalidateConfig(); });
+	sensorRemoved.connect([this](const SensorChip&, SensorType) { invalidateConfig(); });
 }
 
 wm_sensors::SensorChip::~SensorChip() = default;
@@ -55,6 +65,38 @@ wm_sensors::SensorChip::VisibilityFlags wm_sensors::SensorChip::isVisible(Sensor
 	return SensorVisibility::Readable; // TODO implement in  subclasses
 }
 
+void wm_sensors::SensorChip::refresh() const
+{
+	refreshFlight_.run([this] {
+		// refreshFlight_ serialises this, readers of initialized() see data set up by initialize()
+		if (!initialized_.load(std::memory_order_relaxed)) {
+			initialize();
+			initialized_.store(true, std::memory_order_release);
+		}
+		ReadTimer timer{*this, "refresh"};
+		refreshStarted_.store(Clock::now().time_since_epoch().count(), std::memory_order_relaxed);
+		refreshValues();
+	});
+}
+
+bool wm_sensors::SensorChip::initialized() const
+{
+	return initialized_.load(std::memory_order_acquire);
+}
+
+void wm_sensors::SensorChip::initialize() const
+{
+}
+
+void wm_sensors::SensorChip::refreshValues() const
+{
+}
+
+wm_sensors::SensorChip::RefreshDomain wm_sensors::SensorChip::refreshDomain() const
+{
+	return {identifier_.bus, 0};
+}
+
 int wm_sensors::SensorChip::read(SensorType /*type*/, u32 /*attr*/, std::size_t /*channel*/, double& /*val*/) const
 {
 	return -EOPNOTSUPP;
@@ -74,6 +116,196 @@ int wm_sensors::SensorChip::write(SensorType /*type*/, u32 /*attr*/, std::size_t
 	return -EOPNOTSUPP;
 }
 
+void wm_sensors::SensorChip::setEnabled(SensorType type, std::size_t channel, bool enabled)
+{
+	std::lock_guard<std::mutex> lock{enabledMutex_};
+	auto mask = std::make_shared<ChannelMask>(*enabled_);
+	mask->set(type, channel, enabled);
+	enabled_ = std::move(mask);
+}
+
+void wm_sensors::SensorChip::setEnabled(SensorType type, bool enabled)
+{
+	std::lock_guard<std::mutex> lock{enabledMutex_};
+	auto mask = std::make_shared<ChannelMask>(*enabled_);
+	mask->set(type, enabled);
+	enabled_ = std::move(mask);
+}
+
+int wm_sensors::SensorChip::readSample(SensorType type, u32 attr, std::size_t channel, Sample& sample) const
+{
+	int res;
+	readConsistent([&] {
+		res = read(type, attr, channel, sample.value);
+		sample.timestamp = acquisitionTime();
+		sample.sequence = publicationSequence();
+	});
+	return res;
+}
+
+sigslot::scoped_connection wm_sensors::SensorChip::subscribe(
+    SensorType type, std::size_t channel, Deadband deadband, ValueCallback callback) const
+{
+	struct Filter {
+		ChannelHandle handle;
+		Deadband deadband;
+		ValueCallback callback;
+		std::optional<double> notified;
+		std::mutex mutex; // chips with own read threads may publish concurrently with refresh()
+	};
+	auto filter = std::make_shared<Filter>();
+	filter->handle = resolve(type, attributes::generic_input, channel);
+	filter->deadband = deadband;
+	filter->callback = std::move(callback);
+
+	return valuesPublished_.connect([filter](const SensorChip&) {
+		std::lock_guard<std::mutex> lock{filter->mutex};
+		Sample sample;
+		if (filter->handle.read(sample) != 0) {
+			return;
+		}
+		if (filter->notified.has_value()) {
+			const double last = *filter->notified;
+			if (std::isnan(last) && std::isnan(sample.value)) {
+				return;
+			}
+			if (std::isnan(last) == std::isnan(sample.value)) {
+				const double band = std::max(filter->deadband.absolute, filter->deadband.relative * std::abs(last));
+				if (!(std::abs(sample.value - last) > band)) {
+					return;
+				}
+			}
+		}
+		filter->notified = sample.value;
+		filter->callback(filter->handle, sample);
+	});
+}
+
+wm_sensors::SensorChip::Clock::time_point wm_sensors::SensorChip::acquisitionTime() const
+{
+	return Clock::time_point{Clock::duration{acquired_.load(std::memory_order_relaxed)}};
+}
+
+wm_sensors::u64 wm_sensors::SensorChip::publicationSequence() const
+{
+	return sequence_.load(std::memory_order_relaxed);
+}
+
+wm_sensors::SensorChip::ChannelCost
+wm_sensors::SensorChip::readCost(SensorType /*type*/, std::size_t /*channel*/) const
+{
+	switch (identifier_.bus) {
+		case BusType::Virtual: return {ReadCost::Syscall, "refresh"};
+		case BusType::Any:
+		case BusType::ISA:
+		case BusType::PCI:
+		case BusType::ACPI: return {ReadCost::Register, "refresh"};
+		default: return {ReadCost::Bus, "refresh"};
+	}
+}
+
+std::vector<wm_sensors::SensorChip::ReadLatency> wm_sensors::SensorChip::readLatencies() const
+{
+	std::vector<ReadLatency> res;
+	std::lock_guard<std::mutex> lock{latencyMutex_};
+	res.reserve(latencies_.size());
+	for (const auto& [group, stats]: latencies_) {
+		const auto s = stats.summary();
+		res.push_back({group, s.samples, s.mean, s.p99});
+	}
+	return res;
+}
+
+void wm_sensors::SensorChip::recordReadLatency(std::string_view group, std::chrono::nanoseconds latency) const
+{
+	std::lock_guard<std::mutex> lock{latencyMutex_};
+	auto it = latencies_.find(group);
+	if (it == latencies_.end()) {
+		it = latencies_.emplace(std::string(group), utility::LatencyStats{}).first;
+	}
+	it->second.add(latency);
+}
+
+bool wm_sensors::SensorChip::isEnabled(SensorType type, std::size_t channel) const
+{
+	return enabledChannels()->test(type, channel);
+}
+
+std::shared_ptr<const wm_sensors::SensorChip::ChannelMask> wm_sensors::SensorChip::enabledChannels() const
+{
+	std::lock_guard<std::mutex> lock{enabledMutex_};
+	return enabled_;
+}
+
+bool wm_sensors::SensorChip::ChannelMask::test(SensorType type, std::size_t channel) const
+{
+	const auto t = utility::to_underlying(type);
+	if (t >= sensor_type_max) {
+		return true;
+	}
+	if (typeDisabled_[t]) {
+		return false;
+	}
+	return channel >= channelDisabled_[t].size() || !channelDisabled_[t][channel];
+}
+
+bool wm_sensors::SensorChip::ChannelMask::any(SensorType type, std::size_t first, std::size_t count) const
+{
+	for (std::size_t i = first; i < first + count; ++i) {
+		if (test(type, i)) {
+			return true;
+		}
+	}
+	return false;
+}
+
+void wm_sensors::SensorChip::ChannelMask::set(SensorType type, std::size_t channel, bool enabled)
+{
+	const auto t = utility::to_underlying(type);
+	if (t >= sensor_type_max) {
+		return;
+	}
+	auto& disabled = channelDisabled_[t];
+	if (channel >= disabled.size()) {
+		if (enabled) {
+			return;
+		}
+		disabled.resize(channel + 1, false);
+	}
+	disabled[channel] = !enabled;
+}
+
+void wm_sensors::SensorChip::ChannelMask::set(SensorType type, bool enabled)
+{
+	const auto t = utility::to_underlying(type);
+	if (t >= sensor_type_max) {
+		return;
+	}
+	typeDisabled_[t] = !enabled;
+	channelDisabled_[t].clear();
+}
+
+std::shared_ptr<const wm_sensors::SensorChip::Config> wm_sensors::SensorChip::cachedConfig() const
+{
+	std::lock_guard<std::mutex> lock{configMutex_};
+	if (!cachedConfig_) {
+		cachedConfig_ = std::make_shared<const Config>(config());
+	}
+	return cachedConfig_;
+}
+
+wm_sensors::u64 wm_sensors::SensorChip::configEpoch() const
+{
+	return configEpoch_.load(std::memory_order_acquire);
+}
+
+void wm_sensors::SensorChip::invalidateConfig()
+{
+	std::lock_guard<std::mutex> lock{configMutex_};
+	cachedConfig_.reset();
+	configEpoch_.fetch_add(1, std::memory_order_acq_rel);
+}
+
 const wm_sensors::Identifier& wm_sensors::SensorChip::identifier() const
 {
 	return identifier_;
@@ -89,6 +321,63 @@ std::string_view wm_sensors::SensorChip::channelLabel(SensorType type, std::size
 	return result;
 }
 
+wm_sensors::ChannelHandle wm_sensors::SensorChip::resolve(SensorType type, u32 attr, std::size_t channel) const
+{
+	if (type >= SensorType::max) {
+		throw std::out_of_range("Invalid sensor type");
+	}
+	const auto cfg = cachedConfig();
+	const auto& channels = (*cfg)[type].channelAttributes;
+	if (channel >= channels.size() || !(channels[channel] & attr)) {
+		throw std::out_of_range("Chip does not provide requested channel attribute");
+	}
+	return {this, valueSlot(type, attr, channel), type, attr, channel};
+}
+
+const std::atomic<double>*
+wm_sensors::SensorChip::valueSlot(SensorType /*type*/, u32 /*attr*/, std::size_t /*channel*/) const
+{
+	return nullptr;
+}
+
+wm_sensors::ChannelHandle::ChannelHandle()
+    : ChannelHandle(nullptr, nullptr, SensorType::max, 0, 0)
+{
+}
+
+wm_sensors::ChannelHandle::ChannelHandle(
+    const SensorChip* chip, const std::atomic<double>* slot, SensorType type, u32 attr, std::size_t channel)
+    : chip_{chip}
+    , slot_{slot}
+    , type_{type}
+    , attr_{attr}
+    , channel_{channel}
+{
+}
+
+int wm_sensors::ChannelHandle::read(double& val) const
+{
+	if (slot_) {
+		val = slot_->load(std::memory_order_relaxed);
+		return 0;
+	}
+	return chip_ ? chip_->read(type_, attr_, channel_, val) : -ENOENT;
+}
+
+int wm_sensors::ChannelHandle::read(SensorChip::Sample& sample) const
+{
+	if (!chip_) {
+		return -ENOENT;
+	}
+	int res;
+	chip_->readConsistent([&] {
+		res = read(sample.value);
+		sample.timestamp = chip_->acquisitionTime();
+		sample.sequence = chip_->publicationSequence();
+	});
+	return res;
+}
+
 std::ostream& wm_sensors::operator<<(std::ostream& os, SensorType t)
 {
 	switch (t) {
@@ -118,7 +407,7 @@ std::ostream& wm_sensors::operator<<(std::ostream& os, SensorType t)
 wm_sensors::SensorChip::Config&
 wm_sensors::SensorChip::Config::appendChannels(SensorType type, std::size_t count, u32 attributes)
 {
-	auto& dst = sensors[type].channelAttributes;
+	auto& dst = (*this)[type].channelAttributes;
 	for (std::size_t i = 0; i < count; ++i) {
 		dst.push_back(attributes);
 	}
@@ -127,9 +416,9 @@ wm_sensors::SensorChip::Config::appendChannels(SensorType type, std::size_t coun
 
 wm_sensors::SensorChip::Config& wm_sensors::SensorChip::Config::append(const Config& other)
 {
-	for (const auto& s : other.sensors) {
-		auto& ca = this->sensors[s.first].channelAttributes;
-		std::copy(s.second.channelAttributes.begin(), s.second.channelAttributes.end(), std::back_inserter(ca));
+	for (std::size_t i = 0; i < sensors.size(); ++i) {
+		const auto& src = other.sensors[i].channelAttributes;
+		std::copy(src.begin(), src.end(), std::back_inserter(sensors[i].channelAttributes));
 	}
 	return *this;
 }
@@ -138,8 +427,7 @@ wm_sensors::SensorChip::Config::ChannelCounts wm_sensors::SensorChip::Config::nr
 {
 	ChannelCounts res{0};
 	for (u8 i = 0; i < sensor_type_max; ++i) {
-		const auto it = sensors.find(static_cast<SensorType>(i));
-		res[i] = it != sensors.end() ? it->second.channelAttributes.size() : 0;
+		res[i] = sensors[i].channelAttributes.size();
 	}
 	return res;
 }
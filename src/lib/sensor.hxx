@@ -5,14 +5,23 @@
 
 #include "./sensor_path.hxx"
 #include "./utility/enum_bitset.hxx"
+#include "./utility/latency_stats.hxx"
 #include "./utility/macro.hxx"
+#include "./utility/seqlock.hxx"
+#include "./utility/single_flight.hxx"
 #include "./wm_sensor_types.hxx"
 
 #include <sigslot/signal.hpp>
 
 #include <array>
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <iosfwd>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -20,14 +29,41 @@
 #include "wm-sensors_export.h"
 
 namespace wm_sensors {
+	class ChannelHandle;
 
 	class WM_SENSORS_EXPORT SensorChip {
 	public:
+		using Clock = std::chrono::steady_clock;
+
 		virtual ~SensorChip();
 
 		using VisibilityFlags = utility::enum_bitset<SensorVisibility>;
 
 		virtual VisibilityFlags isVisible(SensorType type, u32 attr, std::size_t channel) const;
+
+		/**
+		 * Reads all sensor values from the hardware in a single pass and stores them in the chip cache.
+		 * read() returns cached values only and does not access hardware, query clocks or allocate.
+		 * Implementations hand new values over to readers via publish(), so read() may run concurrently.
+		 * Concurrent calls are coalesced: callers arriving while a refresh is in progress wait for it and reuse its
+		 * result instead of accessing the hardware again. The first call performs the deferred initialize().
+		 */
+		void refresh() const;
+
+		/** Whether the deferred initialization was performed, i.e. refresh() was called */
+		bool initialized() const;
+
+		/** Hardware shared with other chips which refresh() accesses */
+		struct RefreshDomain {
+			BusType bus;     // BusType::Any and BusType::Virtual are not shared
+			u32 systemLocks; // bit mask of system-wide hardware locks taken (EC, ISA, PCI, SMBus)
+		};
+
+		/**
+		 * Chips which share a bus or a system lock are not refreshed concurrently by the library.
+		 * The default implementation returns the identifier bus and no locks.
+		 */
+		virtual RefreshDomain refreshDomain() const;
 		virtual int read(SensorType type, u32 attr, std::size_t channel, double& val) const;
 		virtual int read(SensorType type, u32 attr, std::size_t channel, std::string_view& str) const;
 		virtual int write(SensorType type, u32 attr, std::size_t channel, double val);
@@ -37,7 +73,18 @@ namespace wm_sensors {
 		};
 
 		struct Config {
-			std::map<SensorType, TypeConfig> sensors;
+			// indexed by SensorType
+			std::array<TypeConfig, sensor_type_max> sensors;
+
+			TypeConfig& operator[](SensorType type)
+			{
+				return sensors[utility::to_underlying(type)];
+			}
+
+			const TypeConfig& operator[](SensorType type) const
+			{
+				return sensors[utility::to_underlying(type)];
+			}
 
 			Config& appendChannels(SensorType type, std::size_t count, u32 attributes);
 			Config& append(const Config& other);
@@ -51,20 +98,270 @@ namespace wm_sensors {
 
 		virtual Config config() const = 0;
 
+		/** Set of channels sampled by refresh(), all channels are enabled by default */
+		class ChannelMask {
+		public:
+			bool test(SensorType type, std::size_t channel) const;
+			/** Whether any of channels [first, first + count) is enabled */
+			bool any(SensorType type, std::size_t first, std::size_t count) const;
+
+			void set(SensorType type, std::size_t channel, bool enabled);
+			/** Enables or disables all channels of the type */
+			void set(SensorType type, bool enabled);
+
+		private:
+			std::array<bool, sensor_type_max> typeDisabled_{};
+			std::array<std::vector<bool>, sensor_type_max> channelDisabled_;
+		};
+
+		/**
+		 * Enables or disables sampling of the channel. Drivers skip hardware access behind disabled channels where
+		 * they can and their values read as NaN. Channels stay in config(), so channel numbers do not change.
+		 */
+		void setEnabled(SensorType type, std::size_t channel, bool enabled);
+		/** Enables or disables all channels of the type */
+		void setEnabled(SensorType type, bool enabled);
+		bool isEnabled(SensorType type, std::size_t channel) const;
+
+		/** Order of magnitude of the cost to acquire a channel value from the hardware */
+		enum class ReadCost
+		{
+			Syscall,  // OS counters, no hardware access
+			Register, // MSR, port or PCI configuration access, possibly with a thread affinity switch
+			Firmware, // firmware mailbox (SMU, EC) and a physical memory map
+			Bus,      // round trips over a slow bus (USB HID, SMBus)
+		};
+
+		struct ChannelCost {
+			ReadCost cost;
+			std::string_view group; // channels which are read together, key of readLatencies()
+		};
+
+		/**
+		 * Estimated cost of the channel. The default implementation derives the class from the identifier bus and puts
+		 * all channels into the "refresh" group.
+		 */
+		virtual ChannelCost readCost(SensorType type, std::size_t channel) const;
+
+		struct ReadLatency {
+			std::string group;
+			std::size_t samples;
+			std::chrono::nanoseconds mean;
+			std::chrono::nanoseconds p99;
+		};
+
+		/**
+		 * Measured acquisition latencies over the recent refreshes, per channel group. The "refresh" group is
+		 * the whole refreshValues() pass and is always present once the chip was refreshed.
+		 */
+		std::vector<ReadLatency> readLatencies() const;
+
+		/**
+		 * Result of config(), built on first access and kept until sensorAdded or sensorRemoved fire. The snapshot
+		 * stays valid when the chip replaces it.
+		 */
+		std::shared_ptr<const Config> cachedConfig() const;
+
+		/** Incremented each time sensorAdded or sensorRemoved fire, i.e. when the cached config changes */
+		u64 configEpoch() const;
+
 		const Identifier& identifier() const;
 
 		std::string_view channelLabel(SensorType type, std::size_t channel) const;
 
+		/**
+		 * Resolves a channel attribute into a handle for repeated reads.
+		 * Throws std::out_of_range if the chip does not provide the channel attribute.
+		 */
+		ChannelHandle resolve(SensorType type, u32 attr, std::size_t channel) const;
+
+		struct Sample {
+			double value;
+			Clock::time_point timestamp; // when the hardware was accessed to acquire the value
+			u64 sequence;                // publication counter of the chip, 0 if nothing was published yet
+		};
+
+		/** Reads the channel value together with its acquisition time and publication sequence number */
+		int readSample(SensorType type, u32 attr, std::size_t channel, Sample& sample) const;
+
+		/**
+		 * Acquisition time and sequence number of the published values. Call them from readConsistent() to pair
+		 * them with the values read there.
+		 */
+		Clock::time_point acquisitionTime() const;
+		u64 publicationSequence() const;
+
+		/** Value changes smaller than the larger of the two are not notified */
+		struct Deadband {
+			double absolute = 0.;
+			double relative = 0.; // fraction of the last notified value
+		};
+
+		using ValueCallback = std::function<void(const ChannelHandle& channel, const Sample& sample)>;
+
+		/**
+		 * Subscribes to changes of the channel input value. @p callback is invoked from the thread which publishes
+		 * new values, for the first published value and then each time the value moves beyond @p deadband from the
+		 * last notified one. The subscription ends when the returned connection is disconnected or destroyed.
+		 * Throws std::out_of_range if the chip does not provide the channel input.
+		 */
+		sigslot::scoped_connection
+		subscribe(SensorType type, std::size_t channel, Deadband deadband, ValueCallback callback) const;
+
+		/**
+		 * Invokes @p fn, which reads values of this chip, so that all of them come from the same refresh().
+		 * Does not block refresh(), @p fn is invoked again when it raced with one.
+		 */
+		template <class F>
+		void readConsistent(F&& fn) const
+		{
+			valuesLock_.read(std::forward<F>(fn));
+		}
+
 		sigslot::signal<void(const SensorChip& chip, SensorType type)> sensorAdded;
 		sigslot::signal<void(const SensorChip& chip, SensorType type)> sensorRemoved;
 
 	protected:
 		SensorChip(Identifier id);
 
+		/**
+		 * Expensive hardware setup deferred until the first refresh(), so that chips nobody reads cost nothing.
+		 * Constructors gather what config() needs from cheap identification data only. Invoked before the first
+		 * refreshValues() and again on the next refresh() if it throws. The default does nothing.
+		 */
+		virtual void initialize() const;
+
+		/** Performs the hardware access for refresh(), never invoked concurrently. The default does nothing. */
+		virtual void refreshValues() const;
+
+		/** Channels to sample, take it once per refresh */
+		std::shared_ptr<const ChannelMask> enabledChannels() const;
+
+		/** Records acquisition latency of the channel group, see readLatencies() */
+		void recordReadLatency(std::string_view group, std::chrono::nanoseconds latency) const;
+
+		/** Measures its lifetime as a read of the channel group */
+		class ReadTimer {
+		public:
+			ReadTimer(const SensorChip& chip, std::string_view group)
+			    : chip_{chip}
+			    , group_{group}
+			    , start_{std::chrono::steady_clock::now()}
+			{
+			}
+
+			~ReadTimer()
+			{
+				chip_.recordReadLatency(group_, std::chrono::steady_clock::now() - start_);
+			}
+
+		private:
+			DELETE_COPY_CTOR_AND_ASSIGNMENT(ReadTimer)
+
+			const SensorChip& chip_;
+			std::string_view group_;
+			std::chrono::steady_clock::time_point start_;
+		};
+
+		/**
+		 * Returns address of the published value of the channel attribute, which has to stay valid for the chip
+		 * lifetime, or nullptr if the value is not stored as is. The default implementation returns nullptr.
+		 */
+		virtual const std::atomic<double>* valueSlot(SensorType type, u32 attr, std::size_t channel) const;
+
+		/**
+		 * Runs @p fn, which copies values computed by refresh() into the published (atomic) storage read by
+		 * read() and value slots, as a single update for readConsistent() callers. @p acquired is the time the
+		 * values were read from the hardware.
+		 */
+		template <class F>
+		void publish(F&& fn, Clock::time_point acquired) const
+		{
+			valuesLock_.write([&] {
+				fn();
+				acquired_.store(acquired.time_since_epoch().count(), std::memory_order_relaxed);
+				sequence_.store(sequence_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+			});
+			valuesPublished_(*this);
+		}
+
+		/**
+		 * Publishes values acquired by the refresh() in progress, stamped with the time refreshValues() started.
+		 * Chips publishing from their own threads use the overload above, they would get the start of the last
+		 * refresh otherwise.
+		 */
+		template <class F>
+		void publish(F&& fn) const
+		{
+			publish(std::forward<F>(fn),
+			    Clock::time_point{Clock::duration{refreshStarted_.load(std::memory_order_relaxed)}});
+		}
+
 	private:
 		DELETE_COPY_CTOR_AND_ASSIGNMENT(SensorChip)
 
+		void invalidateConfig();
+
 		Identifier identifier_;
+		mutable std::mutex configMutex_;
+		mutable std::shared_ptr<const Config> cachedConfig_; // guarded by configMutex_
+		std::atomic<u64> configEpoch_;
+		mutable utility::SeqLock valuesLock_;
+		mutable std::atomic<Clock::rep> acquired_; // guarded by valuesLock_
+		mutable std::atomic<u64> sequence_;        // guarded by valuesLock_
+		mutable std::atomic<Clock::rep> refreshStarted_; // chips may publish from their own threads
+		mutable sigslot::signal<void(const SensorChip& chip)> valuesPublished_; // subscribe() filters
+		mutable utility::SingleFlight refreshFlight_;
+		mutable std::atomic<bool> initialized_;
+		mutable std::mutex enabledMutex_;
+		std::shared_ptr<const ChannelMask> enabled_; // replaced on change, so that refresh() can hold a snapshot
+		mutable std::mutex latencyMutex_;
+		mutable std::map<std::string, utility::LatencyStats, std::less<>> latencies_;
+	};
+
+	/** Resolved channel attribute. Reads do not repeat the channel lookup and go to the value cache if possible. */
+	class WM_SENSORS_EXPORT ChannelHandle {
+	public:
+		ChannelHandle();
+
+		int read(double& val) const;
+		int read(SensorChip::Sample& sample) const;
+
+		explicit operator bool() const
+		{
+			return chip_ != nullptr;
+		}
+
+		const SensorChip* chip() const
+		{
+			return chip_;
+		}
+
+		SensorType type() const
+		{
+			return type_;
+		}
+
+		u32 attribute() const
+		{
+			return attr_;
+		}
+
+		std::size_t channel() const
+		{
+			return channel_;
+		}
+
+	private:
+		friend class SensorChip;
+		ChannelHandle(
+		    const SensorChip* chip, const std::atomic<double>* slot, SensorType type, u32 attr, std::size_t channel);
+
+		const SensorChip* chip_;
+		const std::atomic<double>* slot_;
+		SensorType type_;
+		u32 attr_;
+		std::size_t channel_;
 	};
 
 	std::ostream& operator<<(std::ostream& os, SensorType t);
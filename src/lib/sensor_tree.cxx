@@ -3,11 +3,64 @@
 #include "./sensor_tree.hxx"
 
 #include "visitor/chip_visitor.hxx"
+#include "hardware/cpu/generic_cpu.hxx"
+#include "hardware/impl/pinned_samplers.hxx"
 #include "impl/chip_registrator.hxx"
 
 #include <fmt/format.h>
+#include <spdlog/spdlog.h>
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cmath>
+#include <exception>
+#include <limits>
+#include <sstream>
+#include <thread>
+
+namespace {
+	/** Glob match, '*' does not cross path separators */
+	bool pathMatches(std::string_view pattern, std::string_view path)
+	{
+		if (pattern.empty()) {
+			return path.empty();
+		}
+		if (pattern[0] == '*') {
+			for (std::size_t i = 0;; ++i) {
+				if (pathMatches(pattern.substr(1), path.substr(i))) {
+					return true;
+				}
+				if (i == path.size() || path[i] == wm_sensors::TreeNode::pathSeparator) {
+					return false;
+				}
+			}
+		}
+		return !path.empty() && (pattern[0] == '?' || pattern[0] == path[0]) &&
+		       pathMatches(pattern.substr(1), path.substr(1));
+	}
+
+	/** Hands the idle sampling policy of the tree options to the CPU chips */
+	class IdleSamplingSetter: public wm_sensors::SensorChipVisitor {
+	public:
+		explicit IdleSamplingSetter(const wm_sensors::hardware::cpu::GenericCPU::IdleSampling& policy)
+		    : policy_{policy}
+		{
+		}
+
+		void visit(
+		    const NodeAddress& /*path*/, std::size_t /*index*/, const wm_sensors::SensorChip& chip) override
+		{
+			if (const auto* cpu = dynamic_cast<const wm_sensors::hardware::cpu::GenericCPU*>(&chip)) {
+				cpu->setIdleSampling(policy_);
+			}
+		}
+		using wm_sensors::SensorChipVisitor::visit;
+
+	private:
+		wm_sensors::hardware::cpu::GenericCPU::IdleSampling policy_;
+	};
+} // namespace
 
 wm_sensors::TreeNode::TreeNode(TreeNode* parent)
     : parent_{parent}
@@ -64,10 +117,359 @@ wm_sensors::TreeNode::~TreeNode() = default;
 
 wm_sensors::TreeNode::TreeNode(TreeNode&& other) noexcept = default;
 
+struct wm_sensors::SensorsTree::DeferredProbes {
+	std::vector<std::unique_ptr<impl::ProbeRun>> runs;
+	hardware::cpu::GenericCPU::IdleSampling idleSampling;
+	std::thread thread;
+	std::atomic<bool> running{true};
+};
+
+struct wm_sensors::SensorsTree::ChangeLog {
+	struct Channel {
+		ChannelHandle handle;
+		double value;
+		u64 changed; // sequence of the changesSince() call which saw the value change
+	};
+
+	struct Chip {
+		const SensorChip* chip;
+		u64 configEpoch;
+		u64 publication; // SensorChip::publicationSequence() seen by the last scan
+		std::size_t firstChannel;
+		std::size_t channelCount;
+	};
+
+	/** Rebuilds the channel list if chips or their configs changed, keeping the state of the known ones */
+	void update(const std::vector<const SensorChip*>& current);
+	/** Reads channels of chips which published since the last scan */
+	void scan();
+
+	std::vector<Chip> chips;
+	std::vector<Channel> channels;
+	std::vector<double> values; // scan() buffer
+	u64 sequence = 0;
+};
+
+void wm_sensors::SensorsTree::ChangeLog::update(const std::vector<const SensorChip*>& current)
+{
+	const bool same = std::equal(current.begin(), current.end(), chips.begin(), chips.end(),
+	    [](const SensorChip* c, const Chip& known) {
+		    return c == known.chip && c->configEpoch() == known.configEpoch;
+	    });
+	if (same) {
+		return;
+	}
+
+	std::vector<Chip> newChips;
+	std::vector<Channel> newChannels;
+	for (const SensorChip* chip: current) {
+		const u64 configEpoch = chip->configEpoch();
+		const std::size_t first = newChannels.size();
+		const auto known = std::find_if(chips.begin(), chips.end(),
+		    [&](const Chip& c) { return c.chip == chip && c.configEpoch == configEpoch; });
+		if (known != chips.end()) {
+			newChannels.insert(newChannels.end(), channels.begin() + static_cast<std::ptrdiff_t>(known->firstChannel),
+			    channels.begin() + static_cast<std::ptrdiff_t>(known->firstChannel + known->channelCount));
+			newChips.push_back({chip, configEpoch, known->publication, first, known->channelCount});
+			continue;
+		}
+
+		const auto cfg = chip->cachedConfig();
+		for (u8 t = 0; t < sensor_type_max; ++t) {
+			const auto type = static_cast<SensorType>(t);
+			const auto& channelAttributes = cfg->sensors[t].channelAttributes;
+			for (std::size_t i = 0; i < channelAttributes.size(); ++i) {
+				if ((channelAttributes[i] & attributes::generic_input) &&
+				    chip->isVisible(type, attributes::generic_input, i).test(SensorVisibility::Readable)) {
+					newChannels.push_back({chip->resolve(type, attributes::generic_input, i),
+					    std::numeric_limits<double>::quiet_NaN(), sequence});
+				}
+			}
+		}
+		// never scanned, so that the values are read
+		newChips.push_back({chip, configEpoch, 0, first, newChannels.size() - first});
+	}
+	chips = std::move(newChips);
+	channels = std::move(newChannels);
+}
+
+void wm_sensors::SensorsTree::ChangeLog::scan()
+{
+	for (Chip& c: chips) {
+		if (c.chip->publicationSequence() == c.publication && c.publication != 0) {
+			continue;
+		}
+		values.resize(c.channelCount);
+		u64 publication = 0;
+		// readConsistent() may repeat the callback, so values are compared after it returns
+		c.chip->readConsistent([&] {
+			for (std::size_t i = 0; i < c.channelCount; ++i) {
+				if (channels[c.firstChannel + i].handle.read(values[i]) != 0) {
+					values[i] = std::numeric_limits<double>::quiet_NaN();
+				}
+			}
+			publication = c.chip->publicationSequence();
+		});
+		c.publication = publication;
+
+		for (std::size_t i = 0; i < c.channelCount; ++i) {
+			Channel& ch = channels[c.firstChannel + i];
+			const bool bothNaN = std::isnan(ch.value) && std::isnan(values[i]);
+			if (!bothNaN && ch.value != values[i]) {
+				ch.value = values[i];
+				ch.changed = sequence;
+			}
+		}
+	}
+}
+
 wm_sensors::SensorsTree::SensorsTree()
+    : SensorsTree(Options{})
+{
+}
+
+wm_sensors::SensorsTree::SensorsTree(const Options& options)
     : sensors_{std::make_unique<SensorChipTreeNode>(nullptr)}
+    , changeLog_{std::make_unique<ChangeLog>()}
+{
+	if (options.pinnedSamplers) {
+		samplers_ = hardware::impl::PinnedSamplers::acquire();
+	}
+	const hardware::cpu::GenericCPU::IdleSampling idleSampling{options.idleCoreLoad, options.idleCoreInterval};
+
+	auto& registry = impl::ChipProbesRegistry::instance();
+	impl::ChipProbesRegistry::Filter selected;
+	if (!options.includeProbes.empty() || !options.excludeProbes.empty()) {
+		selected = [&options](const impl::ChipProbe& probe) {
+			const auto listed = [&probe](const std::vector<std::string>& names) {
+				return std::find(names.begin(), names.end(), probe.name()) != names.end();
+			};
+			return (options.includeProbes.empty() || listed(options.includeProbes)) && !listed(options.excludeProbes);
+		};
+	}
+
+	if (!options.progressive) {
+		probeTimings_ = registry.probeAll(*sensors_, selected);
+		IdleSamplingSetter setter{idleSampling};
+		sensors_->accept(setter);
+		return;
+	}
+
+	deferred_ = std::make_unique<DeferredProbes>();
+	deferred_->runs = registry.start(true, selected);
+	deferred_->idleSampling = idleSampling;
+	for (const auto& r: registry.start(false, selected)) {
+		probeTimings_.push_back(r->finish(sensors_.get()));
+	}
+	IdleSamplingSetter setter{idleSampling};
+	sensors_->accept(setter);
+	deferred_->thread = std::thread([this] { attachDeferred(); });
+}
+
+wm_sensors::SensorsTree::SensorsTree(SensorsTree&& other)
+{
+	// the deferred probes thread refers to the tree object and locks its mutex, join it without holding the lock;
+	// nothing else may use the tree being moved from
+	if (other.deferred_ && other.deferred_->thread.joinable()) {
+		other.deferred_->thread.join();
+	}
+	sensorAdded = std::move(other.sensorAdded);
+	sensorRemoved = std::move(other.sensorRemoved);
+	chipAdded = std::move(other.chipAdded);
+	chipRemoved = std::move(other.chipRemoved);
+	sensors_ = std::move(other.sensors_);
+	probeTimings_ = std::move(other.probeTimings_);
+	deferred_ = std::move(other.deferred_);
+	changeLog_ = std::move(other.changeLog_);
+	samplers_ = std::move(other.samplers_);
+}
+
+wm_sensors::SensorsTree::~SensorsTree()
+{
+	if (deferred_ && deferred_->thread.joinable()) {
+		deferred_->thread.join();
+	}
+}
+
+void wm_sensors::SensorsTree::attachDeferred()
+{
+	struct ChipCollector: public SensorChipVisitor {
+		void visit(const NodeAddress& path, std::size_t /*index*/, const SensorChip& chip) override
+		{
+			chips.push_back({std::string(path.fullPath), std::string(path.nodeName), &chip});
+		}
+		using SensorChipVisitor::visit;
+
+		struct Item {
+			std::string fullPath;
+			std::string nodeName;
+			const SensorChip* chip;
+		};
+		std::vector<Item> chips;
+	};
+
+	for (const auto& r: deferred_->runs) {
+		const auto deadline = r->started() + r->probe().deadline();
+		if (!r->waitUntil(deadline)) {
+			spdlog::warn("Probe '{}' missed its deadline, its chips are dropped", r->probe().name());
+			std::lock_guard<std::recursive_mutex> lock{mutex_};
+			probeTimings_.push_back({std::string(r->probe().name()),
+			    std::chrono::duration_cast<std::chrono::microseconds>(r->probe().deadline()), false, true});
+			continue;
+		}
+
+		SensorChipTreeNode probed{nullptr};
+		ProbeTiming timing;
+		try {
+			timing = r->finish(&probed);
+		} catch (const std::exception& e) {
+			spdlog::error("Probe '{}' failed: {}", r->probe().name(), e.what());
+			continue;
+		}
+		ChipCollector collector;
+		probed.accept(collector);
+		IdleSamplingSetter setter{deferred_->idleSampling};
+		probed.accept(setter);
+
+		std::lock_guard<std::recursive_mutex> lock{mutex_};
+		sensors_->merge(std::move(probed));
+		probeTimings_.push_back(std::move(timing));
+		for (const auto& c: collector.chips) {
+			chipAdded({c.fullPath, c.nodeName}, *c.chip);
+		}
+	}
+	deferred_->running = false;
+}
+
+std::vector<std::string> wm_sensors::SensorsTree::probeNames()
+{
+	const auto names = impl::ChipProbesRegistry::instance().names();
+	return {names.begin(), names.end()};
+}
+
+std::vector<wm_sensors::ProbeTiming> wm_sensors::SensorsTree::probeTimings() const
+{
+	std::lock_guard<std::recursive_mutex> lock{mutex_};
+	return probeTimings_;
+}
+
+bool wm_sensors::SensorsTree::probing() const
+{
+	return deferred_ && deferred_->running;
+}
+
+std::unique_lock<std::recursive_mutex> wm_sensors::SensorsTree::lock() const
+{
+	return std::unique_lock<std::recursive_mutex>{mutex_};
+}
+
+wm_sensors::ChannelHandle wm_sensors::SensorsTree::resolve(
+    std::string_view nodePath, std::size_t chipIndex, SensorType type, u32 attr, std::size_t channel) const
 {
-	impl::ChipProbesRegistry::instance().probeAll(*sensors_);
+	return sensors_->child(nodePath).payload(chipIndex).resolve(type, attr, channel);
 }
 
-wm_sensors::SensorsTree::SensorsTree(SensorsTree&& other) = default;
+wm_sensors::SensorsSnapshot wm_sensors::SensorsTree::snapshot()
+{
+	class SnapshotLayoutVisitor: public SensorChipVisitor {
+	public:
+		SnapshotLayoutVisitor(SensorsSnapshot& snapshot)
+		    : snapshot_{snapshot}
+		{
+		}
+
+		void visit(const NodeAddress& path, std::size_t index, const SensorChip& chip) override
+		{
+			snapshot_.addChip(std::string(path.fullPath), index, chip);
+		}
+		using SensorChipVisitor::visit;
+
+	private:
+		SensorsSnapshot& snapshot_;
+	};
+
+	SensorsSnapshot res;
+	SnapshotLayoutVisitor v{res};
+	sensors_->accept(v);
+	return res;
+}
+
+wm_sensors::SensorsTree::Changes wm_sensors::SensorsTree::changesSince(u64 sequence) const
+{
+	struct ChipCollector: public SensorChipVisitor {
+		void visit(const NodeAddress& /*path*/, std::size_t /*index*/, const SensorChip& chip) override
+		{
+			chips.push_back(&chip);
+		}
+		using SensorChipVisitor::visit;
+
+		std::vector<const SensorChip*> chips;
+	};
+
+	std::lock_guard<std::recursive_mutex> lock{mutex_};
+	ChipCollector collector;
+	sensors_->accept(collector);
+
+	ChangeLog& log = *changeLog_;
+	++log.sequence;
+	log.update(collector.chips);
+	log.scan();
+
+	Changes res{log.sequence, {}};
+	for (const auto& ch: log.channels) {
+		if (ch.changed > sequence) {
+			res.channels.push_back({ch.handle, ch.value});
+		}
+	}
+	return res;
+}
+
+wm_sensors::SensorsTree::Subscriptions wm_sensors::SensorsTree::subscribe(
+    std::string_view pattern, SensorChip::Deadband deadband, const SensorChip::ValueCallback& callback) const
+{
+	class SubscribingVisitor: public SensorChipVisitor {
+	public:
+		SubscribingVisitor(
+		    std::string_view pattern, SensorChip::Deadband deadband, const SensorChip::ValueCallback& callback)
+		    : pattern_{pattern}
+		    , deadband_{deadband}
+		    , callback_{callback}
+		{
+		}
+
+		void visit(const NodeAddress& path, std::size_t index, const SensorChip& chip) override
+		{
+			const auto cfg = chip.cachedConfig();
+			for (u8 t = 0; t < sensor_type_max; ++t) {
+				const auto type = static_cast<SensorType>(t);
+				const auto& channelAttributes = cfg->sensors[t].channelAttributes;
+				for (std::size_t i = 0; i < channelAttributes.size(); ++i) {
+					if ((channelAttributes[i] & attributes::generic_input) &&
+					    pathMatches(pattern_, fmt::format("{}{}/{}/{}", path.fullPath, index, typeName(type), i))) {
+						subscriptions.push_back(chip.subscribe(type, i, deadband_, callback_));
+					}
+				}
+			}
+		}
+		using SensorChipVisitor::visit;
+
+		Subscriptions subscriptions;
+
+	private:
+		static std::string typeName(SensorType type)
+		{
+			std::ostringstream os;
+			os << type;
+			return os.str();
+		}
+
+		std::string_view pattern_;
+		SensorChip::Deadband deadband_;
+		const SensorChip::ValueCallback& callback_;
+	};
+
+	std::lock_guard<std::recursive_mutex> lock{mutex_};
+	SubscribingVisitor v{pattern, deadband, callback};
+	sensors_->accept(v);
+	return std::move(v.subscriptions);
+}
@@ -4,12 +4,15 @@
 
 #include "./sensor.hxx"
 #include "./sensor_path.hxx"
+#include "./sensors_snapshot.hxx"
 #include "./visitor/chip_visitor.hxx"
 
 #include "utility/utility.hxx"
 
+#include <chrono>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <string>
 #include <string_view>
 #include <type_traits>
@@ -81,6 +84,18 @@ namespace wm_sensors {
 			payload_.push_back(std::move(payload));
 		}
 
+		/** Moves payload and children of @p other into this node, payload is appended after the existing one */
+		void merge(ThisType&& other)
+		{
+			for (auto& p: other.payload_) {
+				payload_.push_back(std::move(p));
+			}
+			other.payload_.clear();
+			for (const auto& cp: other.children()) {
+				child(cp.first).merge(std::move(static_cast<ThisType&>(*cp.second)));
+			}
+		}
+
 		const PayloadObject& payload(std::size_t index) const
 		{
 			if constexpr (std::is_same_v<Payload, PayloadObject>) {
@@ -165,10 +180,49 @@ namespace wm_sensors {
 	using SensorChipTreeNode = SensorTreeNode<HardwareType, std::unique_ptr<SensorChip>>;
 	using SensorChipVisitor = SensorTreeVisitor<SensorChip>;
 
+	/** Outcome of a single hardware probe run while the tree was constructed */
+	struct ProbeTiming {
+		std::string probe;
+		std::chrono::microseconds duration;
+		bool found;    // whether the probe detected any hardware
+		bool timedOut; // deferred probe missed its deadline, its chips were dropped
+	};
+
 	class WM_SENSORS_EXPORT SensorsTree {
 	public:
+		struct Options {
+			/**
+			 * Return as soon as the probes which can not be deferred complete. Deferred probes (motherboard chips
+			 * detection, for example) attach their chips later from a background thread and announce them via
+			 * chipAdded, each within its deadline.
+			 */
+			bool progressive = false;
+			/** Names of the probes to run (see probeNames()), all of them when empty */
+			std::vector<std::string> includeProbes;
+			/** Names of the probes to skip */
+			std::vector<std::string> excludeProbes;
+			/**
+			 * Read per-CPU registers on worker threads pinned to each core instead of moving the refreshing thread
+			 * between CPUs. Cores are then sampled in parallel and the refreshing thread is never migrated. The
+			 * workers are shared by all chips in the process and run while a tree which requested them exists.
+			 * CPUID detection during probing still moves the probing thread over all logical CPUs once.
+			 */
+			bool pinnedSamplers = false;
+			/**
+			 * Cores with a load (0..1) below this threshold are idle: the CPU chips read their per-core registers
+			 * only on every idleCoreInterval-th refresh, which keeps parked cores in deep C-states, and report the
+			 * last read values in between. 0 disables the policy, as does an idleCoreInterval of 0 or 1. The setting
+			 * applies to the CPU chips of this tree only.
+			 */
+			double idleCoreLoad = 0.;
+			unsigned idleCoreInterval = 10;
+		};
+
 		SensorsTree();
+		explicit SensorsTree(const Options& options);
 		SensorsTree(SensorsTree&& other);
+		/** Waits for deferred probes, including those which missed their deadlines */
+		~SensorsTree();
 
 		decltype(SensorChip::sensorAdded) sensorAdded;
 		decltype(SensorChip::sensorRemoved) sensorRemoved;
@@ -187,11 +241,76 @@ namespace wm_sensors {
 		{
 			return *sensors_;
 		}
+
+		/** Hardware probes run so far, concurrently, in the order they were attached */
+		std::vector<ProbeTiming> probeTimings() const;
+
+		/** Names of the available probes, which are hardware classes, such as "cpu" or "motherboard" */
+		static std::vector<std::string> probeNames();
+
+		/** Whether deferred probes are still running */
+		bool probing() const;
+
+		/**
+		 * Locks the tree structure, which deferred probes modify when they attach chips. Needed in the progressive
+		 * mode only, chipAdded is emitted with the lock held.
+		 */
+		std::unique_lock<std::recursive_mutex> lock() const;
+
+		/** Creates a flat snapshot covering all enabled input channels of the current chips */
+		SensorsSnapshot snapshot();
+
+		struct ChannelChange {
+			ChannelHandle handle;
+			double value;
+		};
+
+		struct Changes {
+			u64 sequence; // pass to the next changesSince() call
+			std::vector<ChannelChange> channels;
+		};
+
+		/**
+		 * Returns input channels whose published values changed since @p sequence, which is Changes::sequence of an
+		 * earlier call, or all of them for 0. Chips are not refreshed, channels of chips which did not publish since
+		 * the previous call are not read. Channels of chips attached in between are reported as changed.
+		 */
+		Changes changesSince(u64 sequence) const;
+
+		/** Subscriptions made by subscribe(), they end when the connections are destroyed */
+		using Subscriptions = std::vector<sigslot::scoped_connection>;
+
+		/**
+		 * Subscribes to input channels of the current chips with paths matching @p pattern, see
+		 * SensorChip::subscribe(). Channel path is the node path followed by chip index, channel type and channel
+		 * number, for example "/cpu/0/temp/1". In the pattern '*' matches any part of a path component and '?' any
+		 * single character. Chips attached later by deferred probes are not covered.
+		 */
+		Subscriptions subscribe(
+		    std::string_view pattern, SensorChip::Deadband deadband, const SensorChip::ValueCallback& callback) const;
+
+		/**
+		 * Resolves channel attribute of the chip with the given index at the tree node path.
+		 * Throws if the node, the chip or the channel attribute does not exist.
+		 */
+		ChannelHandle resolve(
+		    std::string_view nodePath, std::size_t chipIndex, SensorType type, u32 attr, std::size_t channel) const;
+
 	private:
 		SensorsTree(const SensorsTree&) = delete;
 		SensorsTree& operator=(const SensorsTree&) = delete;
 
+		struct DeferredProbes;
+		struct ChangeLog;
+
+		void attachDeferred();
+
+		std::shared_ptr<void> samplers_; // keeps the pinned sampler workers running, outlives the chips
 		std::unique_ptr<SensorChipTreeNode> sensors_;
+		std::vector<ProbeTiming> probeTimings_;
+		mutable std::recursive_mutex mutex_;
+		std::unique_ptr<DeferredProbes> deferred_;
+		std::unique_ptr<ChangeLog> changeLog_; // guarded by mutex_
 	};
 
 } // namespace wm_sensors
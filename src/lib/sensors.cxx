@@ -107,12 +107,25 @@ int sensors_chip_name_has_wildcards(const sensors_chip_name* chip)
 }
 
 int sensors_init(FILE* input)
+{
+	return sensors_init_probes(input, nullptr, nullptr);
+}
+
+int sensors_init_probes(FILE* input, const char* const* include, const char* const* exclude)
 {
 	if (input) {
 		spdlog::critical("Config files are not upported yet");
 		return -EOPNOTSUPP;
 	}
-	sensors.reset(new wm_sensors::SensorsTree());
+
+	wm_sensors::SensorsTree::Options options;
+	for (; include && *include; ++include) {
+		options.includeProbes.emplace_back(*include);
+	}
+	for (; exclude && *exclude; ++exclude) {
+		options.excludeProbes.emplace_back(*exclude);
+	}
+	sensors.reset(new wm_sensors::SensorsTree(options));
 
 	class CollectSensorsVisitor: public wm_sensors::SensorChipVisitor {
 	public:
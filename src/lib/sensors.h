@@ -77,6 +77,11 @@ typedef struct sensors_chip_name {
    calling sensors_init() again. */
 WM_SENSORS_EXPORT int sensors_init(FILE* input);
 
+/* Same as sensors_init(), but runs only the selected hardware probes ("cpu",
+   "motherboard", ...). include and exclude are NULL-terminated lists of probe
+   names, NULL include list selects all probes, NULL exclude list skips none. */
+WM_SENSORS_EXPORT int sensors_init_probes(FILE* input, const char* const* include, const char* const* exclude);
+
 /* Clean-up function: You can't access anything after
    this, until the next sensors_init() call! */
 WM_SENSORS_EXPORT void sensors_cleanup(void);
@@ -0,0 +1,138 @@
+// SPDX-License-Identifier: LGPL-3.0+
+
+#include "./sensors_snapshot.hxx"
+
+#include "./impl/refresh_executor.hxx"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+wm_sensors::SensorsSnapshot::SensorsSnapshot()
+    : executor_{std::make_unique<impl::RefreshExecutor>()}
+{
+}
+
+wm_sensors::SensorsSnapshot::SensorsSnapshot(SensorsSnapshot&& other) noexcept = default;
+wm_sensors::SensorsSnapshot& wm_sensors::SensorsSnapshot::operator=(SensorsSnapshot&& other) noexcept = default;
+wm_sensors::SensorsSnapshot::~SensorsSnapshot() = default;
+
+void wm_sensors::SensorsSnapshot::addChip(std::string path, std::size_t index, const SensorChip& chip)
+{
+	const std::size_t chipIndex = chips_.size();
+	const std::size_t firstChannel = channels_.size();
+
+	const u64 configEpoch = chip.configEpoch();
+	const auto cfg = chip.cachedConfig();
+	for (u8 t = 0; t < sensor_type_max; ++t) {
+		const auto type = static_cast<SensorType>(t);
+		const auto& channelAttributes = cfg->sensors[t].channelAttributes;
+		for (std::size_t i = 0; i < channelAttributes.size(); ++i) {
+			if ((channelAttributes[i] & attributes::generic_input) &&
+			    chip.isVisible(type, attributes::generic_input, i).test(SensorVisibility::Readable)) {
+				channels_.push_back({chipIndex, type, i});
+				handles_.push_back(chip.resolve(type, attributes::generic_input, i));
+			}
+		}
+	}
+
+	chips_.push_back({std::move(path), index, &chip, firstChannel, channels_.size() - firstChannel, configEpoch});
+	chipList_.push_back(&chip);
+	groups_ = impl::RefreshExecutor::group(chipList_);
+	chipIndices_.insert({&chip, chipIndex});
+	uninitialized_.reserve(chips_.size());
+	refreshed_.resize(chips_.size());
+
+	values_.resize(channels_.size(), std::numeric_limits<double>::quiet_NaN());
+	timestamps_.resize(channels_.size());
+	validity_.resize(channels_.size(), 0);
+}
+
+void wm_sensors::SensorsSnapshot::update()
+{
+	// channel ranges of chips do not overlap, so chips may be copied from different threads
+	executor_->refreshGroups(groups_, [this](const SensorChip& chip) { copyValues(chips_[chipIndices_.at(&chip)]); });
+}
+
+wm_sensors::SensorsSnapshot::SweepResult wm_sensors::SensorsSnapshot::synchronizedUpdate()
+{
+	uninitialized_.clear();
+	for (const auto& ci: chips_) {
+		if (!ci.chip->initialized()) {
+			uninitialized_.push_back(ci.chip);
+		}
+	}
+	executor_->refresh(uninitialized_);
+
+	const Clock::time_point sweepStarted = Clock::now();
+	executor_->refreshGroupsTogether(
+	    groups_, [this](const SensorChip& chip) { refreshed_[chipIndices_.at(&chip)] = chip.acquisitionTime(); });
+
+	SweepResult res{{}, Clock::duration::zero(), {}};
+	Clock::time_point first = Clock::time_point::max();
+	Clock::time_point last = Clock::time_point::min();
+	for (std::size_t c = 0; c < chips_.size(); ++c) {
+		const Clock::time_point acquired = copyValues(chips_[c]);
+		// the values have to come from the refresh() of this sweep: chips sampling on their own do not publish from
+		// it, a refresh which was already in flight was started before the sweep, and an own publication after
+		// refresh() returned replaces the values of the sweep
+		if (refreshed_[c] < sweepStarted || acquired != refreshed_[c]) {
+			res.unsynchronized.push_back(c);
+			continue;
+		}
+		first = std::min(first, acquired);
+		last = std::max(last, acquired);
+	}
+	if (first > last) {
+		return res;
+	}
+
+	res.timestamp = first + (last - first) / 2;
+	res.skew = last - first;
+	std::size_t u = 0;
+	for (std::size_t c = 0; c < chips_.size(); ++c) {
+		if (u < res.unsynchronized.size() && res.unsynchronized[u] == c) {
+			++u;
+			continue;
+		}
+		const ChipInfo& ci = chips_[c];
+		std::fill_n(timestamps_.begin() + static_cast<std::ptrdiff_t>(ci.firstChannel), ci.channelCount, res.timestamp);
+	}
+	return res;
+}
+
+void wm_sensors::SensorsSnapshot::resolveHandles(ChipInfo& ci)
+{
+	const u64 configEpoch = ci.chip->configEpoch();
+	if (configEpoch == ci.configEpoch) {
+		return;
+	}
+	// the layout stays, channels the chip no longer provides read as invalid
+	for (std::size_t i = ci.firstChannel; i < ci.firstChannel + ci.channelCount; ++i) {
+		try {
+			handles_[i] = ci.chip->resolve(channels_[i].type, attributes::generic_input, channels_[i].channel);
+		} catch (const std::out_of_range&) {
+			handles_[i] = {};
+		}
+	}
+	ci.configEpoch = configEpoch;
+}
+
+wm_sensors::SensorsSnapshot::Clock::time_point wm_sensors::SensorsSnapshot::copyValues(ChipInfo& ci)
+{
+	resolveHandles(ci);
+	Clock::time_point acquired;
+	// all values of the chip come from the same refresh
+	ci.chip->readConsistent([&] {
+		for (std::size_t i = ci.firstChannel; i < ci.firstChannel + ci.channelCount; ++i) {
+			// chips publish NaN for disabled channels and failed reads
+			validity_[i] = handles_[i].read(values_[i]) == 0 && !std::isnan(values_[i]);
+		}
+		acquired = ci.chip->acquisitionTime();
+	});
+	for (std::size_t i = ci.firstChannel; i < ci.firstChannel + ci.channelCount; ++i) {
+		timestamps_[i] = acquired;
+	}
+	return acquired;
+}
@@ -0,0 +1,134 @@
+// SPDX-License-Identifier: LGPL-3.0+
+#ifndef WM_SENSORS_LIB_SENSORS_SNAPSHOT_HXX
+#define WM_SENSORS_LIB_SENSORS_SNAPSHOT_HXX
+
+#include "./sensor.hxx"
+#include "./stdint.hxx"
+#include "./utility/macro.hxx"
+#include "./wm_sensor_types.hxx"
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "wm-sensors_export.h"
+
+namespace wm_sensors {
+	class SensorsTree;
+
+	namespace impl {
+		class RefreshExecutor;
+	}
+
+	/**
+	 * Flat struct-of-arrays view of all enabled input channels in a sensors tree.
+	 *
+	 * Channel layout is fixed when the snapshot is created by SensorsTree::snapshot(), update() only overwrites
+	 * values, timestamps and validity flags in place. Channels of the same chip are stored contiguously.
+	 */
+	class WM_SENSORS_EXPORT SensorsSnapshot {
+	public:
+		using Clock = std::chrono::steady_clock;
+
+		struct ChipInfo {
+			std::string path;  // tree node path of the chip
+			std::size_t index; // chip index within the tree node
+			const SensorChip* chip;
+			std::size_t firstChannel;
+			std::size_t channelCount;
+			u64 configEpoch; // SensorChip::configEpoch() the layout was built from
+		};
+
+		struct ChannelAddress {
+			std::size_t chipIndex; // index into chips()
+			SensorType type;
+			std::size_t channel;
+		};
+
+		SensorsSnapshot();
+		SensorsSnapshot(SensorsSnapshot&& other) noexcept;
+		SensorsSnapshot& operator=(SensorsSnapshot&& other) noexcept;
+		~SensorsSnapshot();
+
+		/**
+		 * Refreshes every chip once and copies its input values into the arrays.
+		 * Chips on independent buses are refreshed concurrently.
+		 */
+		void update();
+
+		struct SweepResult {
+			Clock::time_point timestamp; // shared by the values of the synchronized chips
+			Clock::duration skew;        // spread of the acquisition times of the synchronized chips
+			std::vector<std::size_t> unsynchronized; // indices into chips() of chips which sample on their own
+		};
+
+		/**
+		 * Synchronized sweep: refreshes chips which were never refreshed to get their initialization done, then
+		 * starts refreshes of all chips at once and tags their values with a single timestamp, the middle of
+		 * their acquisition times. Chips sharing a bus are still refreshed one after another, which adds to the
+		 * skew. Values which do not come from the refresh of this sweep, e.g. of chips acquiring them on their own
+		 * thread, keep their acquisition times.
+		 */
+		SweepResult synchronizedUpdate();
+
+		std::size_t size() const
+		{
+			return values_.size();
+		}
+
+		const std::vector<ChipInfo>& chips() const
+		{
+			return chips_;
+		}
+
+		const std::vector<ChannelAddress>& channels() const
+		{
+			return channels_;
+		}
+
+		const std::vector<double>& values() const
+		{
+			return values_;
+		}
+
+		/** Times the values were acquired from the hardware, see SensorChip::acquisitionTime() */
+		const std::vector<Clock::time_point>& timestamps() const
+		{
+			return timestamps_;
+		}
+
+		/** Non-zero for channels whose last read succeeded and returned a number */
+		const std::vector<u8>& validity() const
+		{
+			return validity_;
+		}
+
+	private:
+		friend class SensorsTree;
+		DELETE_COPY_CTOR_AND_ASSIGNMENT(SensorsSnapshot)
+
+		void addChip(std::string path, std::size_t index, const SensorChip& chip);
+		/** Resolves handles of the chip channels again if the chip configuration changed since they were resolved */
+		void resolveHandles(ChipInfo& ci);
+		/** Copies values of the chip, returns their acquisition time */
+		Clock::time_point copyValues(ChipInfo& ci);
+
+		std::vector<ChipInfo> chips_;
+		// built by addChip() and reused, so that updates do not allocate
+		std::vector<const SensorChip*> chipList_;
+		std::vector<std::vector<const SensorChip*>> groups_; // chipList_ split by RefreshExecutor::group()
+		std::map<const SensorChip*, std::size_t> chipIndices_; // into chips_
+		std::vector<const SensorChip*> uninitialized_;
+		std::vector<Clock::time_point> refreshed_; // acquisition times seen right after the sweep refreshed the chips
+		std::vector<ChannelAddress> channels_;
+		std::vector<ChannelHandle> handles_;
+		std::vector<double> values_;
+		std::vector<Clock::time_point> timestamps_;
+		std::vector<u8> validity_;
+		std::unique_ptr<impl::RefreshExecutor> executor_;
+	};
+} // namespace wm_sensors
+
+#endif
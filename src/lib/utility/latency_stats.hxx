@@ -0,0 +1,58 @@
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef WM_SENSORS_LIB_UTILITY_LATENCY_STATS_HXX
+#define WM_SENSORS_LIB_UTILITY_LATENCY_STATS_HXX
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+
+namespace wm_sensors::utility {
+	/**
+	 * @brief Mean and 99th percentile over the most recent duration samples
+	 *
+	 * Samples are kept in a fixed ring, so adding one does not allocate. Not thread-safe.
+	 */
+	class LatencyStats {
+	public:
+		using Duration = std::chrono::nanoseconds;
+
+		static constexpr const std::size_t window = 256;
+
+		struct Summary {
+			std::size_t samples; // total number of samples added, the statistics cover the last window of them
+			Duration mean;
+			Duration p99;
+		};
+
+		void add(Duration d) noexcept
+		{
+			samples_[count_ % window] = d;
+			++count_;
+		}
+
+		Summary summary() const
+		{
+			const std::size_t n = std::min(count_, window);
+			if (n == 0) {
+				return {0, Duration::zero(), Duration::zero()};
+			}
+			std::array<Duration, window> sorted;
+			std::copy_n(samples_.begin(), n, sorted.begin());
+			Duration::rep sum = 0;
+			for (std::size_t i = 0; i < n; ++i) {
+				sum += sorted[i].count();
+			}
+			const std::size_t p99Index = (n * 99 + 99) / 100 - 1;
+			std::nth_element(sorted.begin(), sorted.begin() + p99Index, sorted.begin() + n);
+			return {count_, Duration{sum / static_cast<Duration::rep>(n)}, sorted[p99Index]};
+		}
+
+	private:
+		std::array<Duration, window> samples_{};
+		std::size_t count_ = 0;
+	};
+} // namespace wm_sensors::utility
+
+#endif
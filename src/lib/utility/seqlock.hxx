@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef WM_SENSORS_LIB_UTILITY_SEQLOCK_HXX
+#define WM_SENSORS_LIB_UTILITY_SEQLOCK_HXX
+
+#include "../stdint.hxx"
+
+#include <atomic>
+#include <thread>
+
+namespace wm_sensors::utility {
+	/**
+	 * @brief Sequence lock: writers are serialized, readers never block them and retry instead
+	 *
+	 * Data guarded by the lock has to be accessed via relaxed atomic operations inside write() and read() callbacks.
+	 * The read callback may be invoked several times and must not have side effects beyond the loaded values.
+	 */
+	class SeqLock {
+	public:
+		SeqLock() noexcept
+		    : sequence_{0}
+		{
+		}
+
+		template <class F>
+		void write(F&& fn)
+		{
+			u64 seq = sequence_.load(std::memory_order_relaxed);
+			while ((seq & 1) ||
+			       !sequence_.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire, std::memory_order_relaxed)) {
+				std::this_thread::yield();
+				seq = sequence_.load(std::memory_order_relaxed);
+			}
+			std::atomic_thread_fence(std::memory_order_release);
+			fn();
+			sequence_.store(seq + 2, std::memory_order_release);
+		}
+
+		template <class F>
+		void read(F&& fn) const
+		{
+			for (;;) {
+				const u64 seq = sequence_.load(std::memory_order_acquire);
+				if (seq & 1) {
+					std::this_thread::yield();
+					continue;
+				}
+				fn();
+				std::atomic_thread_fence(std::memory_order_acquire);
+				if (sequence_.load(std::memory_order_relaxed) == seq) {
+					return;
+				}
+			}
+		}
+
+		/** Even number, incremented by 2 with each completed write */
+		u64 sequence() const noexcept
+		{
+			return sequence_.load(std::memory_order_acquire) & ~u64{1};
+		}
+
+	private:
+		std::atomic<u64> sequence_;
+	};
+} // namespace wm_sensors::utility
+
+#endif
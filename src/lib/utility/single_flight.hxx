@@ -0,0 +1,51 @@
+// SPDX-License-Identifier: LGPL-3.0+
+
+#ifndef WM_SENSORS_LIB_UTILITY_SINGLE_FLIGHT_HXX
+#define WM_SENSORS_LIB_UTILITY_SINGLE_FLIGHT_HXX
+
+#include "../stdint.hxx"
+
+#include <atomic>
+#include <mutex>
+
+namespace wm_sensors::utility {
+	/**
+	 * @brief Coalesces concurrent invocations of an operation
+	 *
+	 * The first caller runs the operation, callers arriving while it is in flight wait for it to complete and
+	 * return without running the operation again, reusing its result.
+	 */
+	class SingleFlight {
+	public:
+		SingleFlight() noexcept
+		    : generation_{0}
+		{
+		}
+
+		/** Returns true if @p fn was invoked by this call, false if the call joined another one */
+		template <class F>
+		bool run(F&& fn)
+		{
+			const u64 generation = generation_.load(std::memory_order_acquire);
+			std::lock_guard<std::mutex> lock{mutex_};
+			if (generation_.load(std::memory_order_relaxed) != generation) {
+				return false;
+			}
+			fn();
+			generation_.store(generation + 1, std::memory_order_release);
+			return true;
+		}
+
+		/** Number of completed operations */
+		u64 generation() const noexcept
+		{
+			return generation_.load(std::memory_order_acquire);
+		}
+
+	private:
+		std::mutex mutex_;
+		std::atomic<u64> generation_;
+	};
+} // namespace wm_sensors::utility
+
+#endif